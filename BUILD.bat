@@ -2,6 +2,7 @@
 
 SET ROOT_PATH=%cd%
 SET DIST_WIN=dist/x86_64-win64-gvs
+SET TEST_WIN=dist/x86_64-win64-gvs-alloc-test
 SET CPP_VERS=c++2a
 SET COMPILER=zig c++
 
@@ -18,5 +19,16 @@ ECHO Testing build . . .
 
 %ROOT_PATH%/%DIST_WIN%/gvs.exe "tests.gvs"
 %ROOT_PATH%/%DIST_WIN%/gvs.exe "syntax.gvs"
+%ROOT_PATH%/%DIST_WIN%/gvs.exe "tests.gvs" --jit-diff
+%ROOT_PATH%/%DIST_WIN%/gvs.exe "syntax.gvs" --jit-diff
+
+@ECHO OFF
+ECHO Building %TEST_WIN%, which counts allocations . . .
+rmdir /S /Q %TEST_WIN%
+mkdir %TEST_WIN%
+%COMPILER% -g main.cpp -o %TEST_WIN%/gvs.exe -static -std=%CPP_VERS% -m64 -Ofast -Werror -Wall -Wextra -pedantic -DGVS_COUNT_ALLOCATIONS=1
+@ECHO ON
+
+%ROOT_PATH%/%TEST_WIN%/gvs.exe "alloc_tests.gvs"
 
 PAUSE
\ No newline at end of file
@@ -5,10 +5,11 @@
 #include "source/types/error.hpp"
 #include "source/arguments/parse_arguments.hpp"
 #include "source/router/router.hpp"
+#include "source/output/output.hpp"
 
 int32_t ManagedMain(const int32_t argc, char *argv[])
 {
-    Logger::Debug("Started Program.", {});
+    LOG_DEBUG("Started Program.", {});
 
     if (Arguments::Parse(argc, argv))
     {
@@ -22,7 +23,7 @@ int32_t ManagedMain(const int32_t argc, char *argv[])
         return 1;
     }
 
-    Logger::Debug("Successfuly Finished Program.", {});
+    LOG_DEBUG("Successfuly Finished Program.", {});
     return 0;
 }
 
@@ -30,12 +31,15 @@ int32_t main(int32_t argc, char *argv[])
 {
     try
     {
-        return ManagedMain(argc, argv);
+        int32_t exit_code = ManagedMain(argc, argv);
+        Output::Flush();
+        return exit_code;
     }
     catch (const std::exception &e)
     {
+        Output::Flush();
         std::cerr << e.what() << '\n';
-        Logger::Debug("Terminated program due to interpreter error.", {});
+        LOG_DEBUG("Terminated program due to interpreter error.", {});
         return 1;
     }
 }
\ No newline at end of file
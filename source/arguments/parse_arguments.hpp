@@ -13,10 +13,32 @@ namespace Arguments
 {
     const std::string ARG_HELP{"-h"};
     const std::string ARG_VERSION{"-v"};
+    const std::string ARG_QUICKEN_STATS{"--quicken-stats"};
+    const std::string ARG_JIT{"--jit"};
+    const std::string ARG_JIT_THRESHOLD{"--jit-threshold"};
+    const std::string ARG_JIT_DIFF{"--jit-diff"};
+    const std::string ARG_LOG_LEVEL{"--log-level"};
+    const std::string ARG_STATS{"--stats"};
+    const std::string ARG_PROFILE{"--profile"};
+    const std::string ARG_PROFILE_HZ{"--profile-hz"};
+    const std::string ARG_MEM_REPORT{"--mem-report"};
+    const std::string ARG_GC_STATS{"--gc-stats"};
+    const std::string ARG_LINE_BUFFERED{"--line-buffered"};
 
     const std::unordered_map<std::string, bool> AVAILABLE_ARGS{
         {ARG_HELP, false},
         {ARG_VERSION, false},
+        {ARG_QUICKEN_STATS, false},
+        {ARG_JIT, false},
+        {ARG_JIT_THRESHOLD, true},
+        {ARG_JIT_DIFF, false},
+        {ARG_LOG_LEVEL, true},
+        {ARG_STATS, false},
+        {ARG_PROFILE, true},
+        {ARG_PROFILE_HZ, true},
+        {ARG_MEM_REPORT, false},
+        {ARG_GC_STATS, false},
+        {ARG_LINE_BUFFERED, false},
     };
 
     Error Parse(const int32_t argc, char *argv[])
@@ -34,7 +56,7 @@ namespace Arguments
 
         if (argc > 0)
         {
-            Logger::Debug("Arg0:", {argv[0]});
+            LOG_DEBUG("Arg0:", {argv[0]});
         }
 
         for (int16_t i = 1; i < argc; ++i)
@@ -44,6 +66,17 @@ namespace Arguments
             if (next_arg)
             {
                 Global::args[previous_arg] = arg;
+                next_arg = false;
+                continue;
+            }
+
+            // '--name=value' form, also accepted by arguments which take no separate value.
+            size_t equals = arg.find('=');
+            if (arg.starts_with("--") && equals != std::string::npos &&
+                Helper::UnorderedMapHasKey(AVAILABLE_ARGS, arg.substr(0, equals)))
+            {
+                LOG_DEBUG("Found argument:", {arg});
+                Global::args[arg.substr(0, equals)] = arg.substr(equals + 1);
                 continue;
             }
 
@@ -68,10 +101,16 @@ namespace Arguments
                 next_arg = AVAILABLE_ARGS.at(arg);
             }
 
-            Logger::Debug("Found argument:", {arg});
+            LOG_DEBUG("Found argument:", {arg});
             Global::args[arg] = "";
             previous_arg = arg;
         }
+
+        if (next_arg)
+        {
+            Logger::Error("Missing value for argument:", {previous_arg});
+            return Error::ASSERTION;
+        }
         return Error::OK;
     }
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <unordered_map>
 #include <functional>
+#include <sstream>
 #include <cstdint>
 
 #include "../logger/logger.hpp"
@@ -10,22 +11,28 @@
 #include "../types/variant.hpp"
 
 #include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "../memory/allocation_counter.hpp"
+#include "../trace/trace.hpp"
+#include "../output/output.hpp"
+#include "typed_array_funcs.hpp"
+#include "map_funcs.hpp"
+#include "string_funcs.hpp"
+#include "number_format.hpp"
+#include "../operators/compare.hpp"
 
 namespace BuiltinFuncs
 {
-    Variant AddI(std::vector<Variant> args, bool &errored)
-    {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0ULL,
-        };
+    using BuiltinFunc = Variant (*)(const Variant *args, size_t args_count, bool &errored);
 
+    Variant AddI(const Variant *args, size_t args_count, bool &errored)
+    {
         VarInt result = 0LL;
 
-        for (auto v : args)
+        for (size_t i = 0; i < args_count; ++i)
         {
-            switch (v.type)
+            const Variant &v = args[i];
+            switch (VarType(v))
             {
             case VALUE_TYPE::INT:
                 result += VarGetInt(v);
@@ -36,28 +43,21 @@ namespace BuiltinFuncs
             default:
                 Logger::Error("Type Error: AddI only takes arguments of type int or float.", {});
                 errored = true;
-                return ret;
+                return NIL_VALUE;
             }
         }
 
-        ret.type = VALUE_TYPE::INT;
-        ret.d64 = std::bit_cast<uint64_t>(result);
-        return ret;
+        return VarMakeInt(result);
     }
 
-    Variant AddF(std::vector<Variant> args, bool &errored)
+    Variant AddF(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0ULL,
-        };
-
         VarFloat result = 0.0;
 
-        for (auto v : args)
+        for (size_t i = 0; i < args_count; ++i)
         {
-            switch (v.type)
+            const Variant &v = args[i];
+            switch (VarType(v))
             {
             case VALUE_TYPE::INT:
                 result += static_cast<VarFloat>(VarGetInt(v));
@@ -68,34 +68,27 @@ namespace BuiltinFuncs
             default:
                 Logger::Error("Type Error: AddF only takes arguments of type int or float.", {});
                 errored = true;
-                return ret;
+                return NIL_VALUE;
             }
         }
 
-        ret.type = VALUE_TYPE::FLOAT;
-        ret.d64 = std::bit_cast<uint64_t>(result);
-        return ret;
+        return VarMakeFloat(result);
     }
 
-    Variant Add(std::vector<Variant> args, bool &errored)
+    Variant Add(const Variant *args, size_t args_count, bool &errored)
     {
-        return AddF(args, errored);
+        return AddF(args, args_count, errored);
     }
 
-    Variant MulI(std::vector<Variant> args, bool &errored)
+    Variant MulI(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0ULL,
-        };
-
         VarInt result = 0LL;
         bool first = true;
 
-        for (auto v : args)
+        for (size_t i = 0; i < args_count; ++i)
         {
-            switch (v.type)
+            const Variant &v = args[i];
+            switch (VarType(v))
             {
             case VALUE_TYPE::INT:
                 if (first)
@@ -116,30 +109,23 @@ namespace BuiltinFuncs
             default:
                 Logger::Error("Type Error: MulI only takes arguments of type int or float.", {});
                 errored = true;
-                return ret;
+                return NIL_VALUE;
             }
             first = false;
         }
 
-        ret.type = VALUE_TYPE::INT;
-        ret.d64 = std::bit_cast<uint64_t>(result);
-        return ret;
+        return VarMakeInt(result);
     }
 
-    Variant MulF(std::vector<Variant> args, bool &errored)
+    Variant MulF(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0ULL,
-        };
-
         VarFloat result = 0.0;
         bool first = true;
 
-        for (auto v : args)
+        for (size_t i = 0; i < args_count; ++i)
         {
-            switch (v.type)
+            const Variant &v = args[i];
+            switch (VarType(v))
             {
             case VALUE_TYPE::INT:
                 if (first)
@@ -160,829 +146,491 @@ namespace BuiltinFuncs
             default:
                 Logger::Error("Type Error: MulF only takes arguments of type int or float.", {});
                 errored = true;
-                return ret;
+                return NIL_VALUE;
             }
             first = false;
         }
 
-        ret.type = VALUE_TYPE::FLOAT;
-        ret.d64 = std::bit_cast<uint64_t>(result);
-        return ret;
+        return VarMakeFloat(result);
     }
 
-    Variant Mul(std::vector<Variant> args, bool &errored)
+    Variant Mul(const Variant *args, size_t args_count, bool &errored)
     {
-        return MulF(args, errored);
+        return MulF(args, args_count, errored);
     }
 
-    Variant ToString(std::vector<Variant> args, bool &errored)
+    Variant ToString(const Variant *args, size_t args_count, bool &errored)
     {
-        if (args.size() != 1)
+        if (args_count != 1)
         {
             Logger::Error("Syntax Error: ToString function takes 1 argument.", {});
             errored = true;
-            return Variant{
-                .type = VALUE_TYPE::NIL,
-                .flags = {},
-                .d64 = 0,
-            };
-        }
-        Variant &arg0 = args.at(0);
-
-        Variant ret{
-            .type = VALUE_TYPE::STRING,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        std::string s = "";
-        switch (arg0.type)
-        {
-        case VALUE_TYPE::STRING:
-            return arg0;
-        case VALUE_TYPE::INT:
-            s = std::to_string(VarGetInt(arg0));
-            break;
-        case VALUE_TYPE::FLOAT:
-            s = std::to_string(VarGetFloat(arg0));
-            break;
-        case VALUE_TYPE::NIL:
-            s = "null";
-        default:
-            break;
-        }
-        ret.d64 = Memory::strings.size();
-        Memory::strings.push_back(s);
-        return ret;
+            return NIL_VALUE;
+        }
+        if (VarType(args[0]) == VALUE_TYPE::STRING)
+            return args[0];
+        char buf[NUMBER_TEXT_SIZE];
+        return VarCopyString(FormatValue(args[0], buf));
     }
 
-    Variant GetLine(std::vector<Variant> args, bool &errored)
+    Variant GetLine(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::STRING,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() > 1)
+        if (args_count > 1)
         {
             Logger::Error("Syntax Error: GetLine function takes 1 or no arguments.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        if (args.size() == 1)
-        {
-            Variant arg = args.at(0);
-            Variant as_str = BuiltinFuncs::ToString({arg}, errored);
-            if (errored)
-                return ret;
-            std::cout << VarGetString(as_str);
-        }
+        char buf[NUMBER_TEXT_SIZE];
+        if (args_count == 1)
+            Output::Write(FormatValue(args[0], buf));
 
+        // The prompt and everything before it must be visible while waiting.
+        Output::Flush();
         std::string input;
         std::getline(std::cin, input);
 
-        ret.d64 = Memory::strings.size();
-        Memory::strings.push_back(input);
-        return ret;
+        return VarMakeString(std::move(input));
     }
 
-    Variant GetChar(std::vector<Variant> args, bool &errored)
+    Variant GetChar([[maybe_unused]] const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::INT,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() > 0)
+        if (args_count > 0)
         {
             Logger::Error("Syntax Error: GetChar function takes no arguments.", {});
             errored = true;
-            return ret;
+            return VarMakeInt(0);
         }
 
+        Output::Flush();
         int c = Helper::GetUnbufferedChar();
-        ret.d64 = std::bit_cast<uint64_t>(static_cast<int64_t>(c));
-        return ret;
+        return VarMakeInt(static_cast<VarInt>(c));
     }
 
-    Variant StrFromChar(std::vector<Variant> args, bool &errored)
+    Variant StrFromChar(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::STRING,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() != 1)
+        if (args_count != 1)
         {
             Logger::Error("Syntax Error: StrFromChar function takes 1 argument.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        Variant arg0 = args.at(0);
-        if (arg0.type != VALUE_TYPE::INT)
+        if (VarType(args[0]) != VALUE_TYPE::INT)
         {
             Logger::Error("Type Error: StrFromChar function 1 argument of type int.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        std::string s = std::string(1, static_cast<char>(std::bit_cast<int64_t>(arg0.d64)));
-        ret.d64 = Memory::strings.size();
-        Memory::strings.push_back(s);
-        return ret;
+        char c = static_cast<char>(VarGetInt(args[0]));
+        return VarCopyString(std::string_view(&c, 1));
     }
 
-    Variant Print(std::vector<Variant> args, bool &errored)
+    Variant Print(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() < 1)
+        if (args_count < 1)
         {
             Logger::Error("Syntax Error: Print function takes at least 1 argument.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
+        char buf[NUMBER_TEXT_SIZE];
         bool first = true;
 
-        for (auto arg : args)
+        for (size_t i = 0; i < args_count; ++i)
         {
+            const Variant &arg = args[i];
             if (!first)
-                std::cout << " ";
+                Output::Write(" ");
 
-            if (arg.type == VALUE_TYPE::STRING)
-            {
-                std::cout << VarGetString(arg);
-            }
-            else
-            {
-                Variant as_str = BuiltinFuncs::ToString({arg}, errored);
-                if (errored)
-                    return ret;
-                std::cout << VarGetString(as_str);
-            }
+            // Numbers are formatted on the stack, printing allocates no string values.
+            Output::Write(FormatValue(arg, buf));
             first = false;
         }
 
-        std::cout << "\n";
-        return ret;
+        Output::EndLine();
+        return NIL_VALUE;
     }
 
-    Variant Panic(std::vector<Variant> args, bool &errored)
+    // Writes out what Print buffered so far.
+    Variant Flush([[maybe_unused]] const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0,
-        };
+        if (args_count > 0)
+        {
+            Logger::Error("Syntax Error: 'Flush' function takes no arguments.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+        Output::Flush();
+        return NIL_VALUE;
+    }
 
-        if (args.size() < 1)
+    Variant Panic(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count < 1)
         {
             Logger::Error("Syntax Error: Panic function takes at least 1 argument.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
+        // What was printed before the panic comes first.
+        Output::Flush();
+        char buf[NUMBER_TEXT_SIZE];
         bool first = true;
 
-        for (auto arg : args)
+        for (size_t i = 0; i < args_count; ++i)
         {
+            const Variant &arg = args[i];
             if (!first)
                 std::cerr << " ";
 
-            if (arg.type == VALUE_TYPE::STRING)
-            {
-                std::cerr << VarGetString(arg);
-            }
-            else
-            {
-                Variant as_str = BuiltinFuncs::ToString({arg}, errored);
-                if (errored)
-                    return ret;
-                std::cerr << VarGetString(as_str);
-            }
+            std::cerr << FormatValue(arg, buf);
             first = false;
         }
 
         std::cerr << "\n";
+        Trace::Dump(std::cerr);
         errored = true;
-        return ret;
+        return NIL_VALUE;
     }
 
-    Variant Equals(std::vector<Variant> args, bool &errored)
+    namespace
     {
-        Variant ret{
-            .type = VALUE_TYPE::INT,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() < 2)
+        // Shared body of the comparison builtins, see Operators::ORDER::MISMATCH for values of unrelated types.
+        Variant CompareBuiltin(OPCODE op, const char *name, const Variant *args, size_t args_count, bool &errored)
         {
-            Logger::Error("Syntax Error: Equals function takes 2 arguments.", {});
-            errored = true;
-            return ret;
-        }
-
-        Variant arg0 = args.at(0);
-        Variant arg1 = args.at(1);
-
-        switch (arg0.type)
-        {
-        case VALUE_TYPE::STRING:
-        {
-            if (arg1.type != VALUE_TYPE::STRING)
+            if (args_count < 2)
             {
-                return ret;
+                Logger::Error("Syntax Error: function", {name, "takes 2 arguments."});
+                errored = true;
+                return VarMakeInt(0);
             }
-            std::string str0 = VarGetString(arg0);
-            std::string str1 = VarGetString(arg1);
 
-            if (str0 == str1)
+            VALUE_TYPE type = VarType(args[0]);
+            if (type != VALUE_TYPE::STRING && type != VALUE_TYPE::INT && type != VALUE_TYPE::FLOAT && type != VALUE_TYPE::NIL)
             {
-                ret.d64 = 1LL;
-                return ret;
-            }
-            return ret;
-        }
-        case VALUE_TYPE::INT:
-        {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetInt(arg0) == 0LL)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetInt(arg0) == VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetInt(arg0) == VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
-            }
-            return ret;
-        }
-        case VALUE_TYPE::FLOAT:
-        {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetFloat(arg0) == 0.0)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetFloat(arg0) == VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetFloat(arg0) == VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
-            }
-            return ret;
-        }
-        case VALUE_TYPE::NIL:
-        {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                ret.d64 = 1LL;
-                return ret;
-            case VALUE_TYPE::INT:
-                if (0LL == VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (0.0 == VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
+                Logger::Error("Type Error: function", {name, "only handles strings, ints, floats or null."});
+                errored = true;
+                return VarMakeInt(0);
             }
-            return ret;
-        }
-        default:
-            Logger::Error("Type Error: Equals function only handles strings, ints, floats or null.", {});
-            errored = true;
-            return ret;
+
+            Operators::ORDER order = Operators::Order(args[0], args[1], Operators::IsEquality(op));
+            return VarMakeInt(Operators::Holds(op, order) ? 1 : 0);
         }
     }
 
-    Variant NotEquals(std::vector<Variant> args, bool &errored)
+    Variant Equals(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::INT,
-            .flags = {},
-            .d64 = 0,
-        };
+        return CompareBuiltin(OPCODE::EQ, "Equals", args, args_count, errored);
+    }
+
+    Variant NotEquals(const Variant *args, size_t args_count, bool &errored)
+    {
+        return CompareBuiltin(OPCODE::NE, "NotEquals", args, args_count, errored);
+    }
 
-        if (args.size() < 2)
+    Variant Greater(const Variant *args, size_t args_count, bool &errored)
+    {
+        return CompareBuiltin(OPCODE::GT, "Greater", args, args_count, errored);
+    }
+
+    Variant Lesser(const Variant *args, size_t args_count, bool &errored)
+    {
+        return CompareBuiltin(OPCODE::LT, "Lesser", args, args_count, errored);
+    }
+
+    Variant Len(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count < 1)
         {
-            Logger::Error("Syntax Error: NotEquals function takes 2 arguments.", {});
+            Logger::Error("Syntax Error: 'Len' function takes 1 argument.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        Variant arg0 = args.at(0);
-        Variant arg1 = args.at(1);
+        // Read in place, taking the length of a string copies nothing.
+        const Variant &arg0 = args[0];
 
-        switch (arg0.type)
-        {
-        case VALUE_TYPE::STRING:
+        if (VarType(arg0) != VALUE_TYPE::ARRAY && VarType(arg0) != VALUE_TYPE::TYPED_ARRAY && VarType(arg0) != VALUE_TYPE::STRING)
         {
-            if (arg1.type != VALUE_TYPE::STRING)
-            {
-                return ret;
-            }
-            std::string str0 = VarGetString(arg0);
-            std::string str1 = VarGetString(arg1);
-
-            if (str0 != str1)
-            {
-                ret.d64 = 1LL;
-                return ret;
-            }
-            return ret;
+            Logger::Error("Type Error: Argument 1 of function 'Len' must be of type 'array' or 'string'.", {});
+            errored = true;
+            return NIL_VALUE;
         }
-        case VALUE_TYPE::INT:
+
+        size_t size = 0ULL;
+
+        if (VarType(arg0) == VALUE_TYPE::ARRAY || VarType(arg0) == VALUE_TYPE::TYPED_ARRAY)
         {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetInt(arg0) != 0LL)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetInt(arg0) != VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetInt(arg0) != VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
-            }
-            return ret;
+            size = VarArraySize(arg0);
         }
-        case VALUE_TYPE::FLOAT:
+        else if (VarType(arg0) == VALUE_TYPE::STRING)
         {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetFloat(arg0) != 0.0)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetFloat(arg0) != VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetFloat(arg0) != VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
-            }
-            return ret;
+            size = VarGetString(arg0).length();
         }
-        case VALUE_TYPE::NIL:
+
+        if (size > static_cast<uint64_t>(INT64_MAX))
         {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                ret.d64 = 0LL;
-                return ret;
-            case VALUE_TYPE::INT:
-                if (0LL != VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (0.0 != VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
-            }
-            return ret;
-        }
-        default:
-            Logger::Error("Type Error: NotEquals function only handles strings, ints, floats or null.", {});
-            errored = true;
-            return ret;
+            size = INT64_MAX;
         }
+        return VarMakeInt(static_cast<VarInt>(size));
     }
 
-    Variant Greater(std::vector<Variant> args, bool &errored)
+    Variant At(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::INT,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() < 2)
+        if (args_count < 2)
         {
-            Logger::Error("Syntax Error: Equals function takes 2 arguments.", {});
+            Logger::Error("Syntax Error: 'At' function takes 2 arguments.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        Variant arg0 = args.at(0);
-        Variant arg1 = args.at(1);
+        // Read in place, a character of a string is one load whatever its length.
+        const Variant &arg0 = args[0];
+        const Variant &arg1 = args[1];
 
-        switch (arg0.type)
+        if (VarType(arg0) != VALUE_TYPE::ARRAY && VarType(arg0) != VALUE_TYPE::TYPED_ARRAY && VarType(arg0) != VALUE_TYPE::STRING)
         {
-        case VALUE_TYPE::INT:
+            Logger::Error("Type Error: Argument 1 of function 'At' must be of type 'array' or 'string'.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        if (VarType(arg1) != VALUE_TYPE::INT)
         {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetInt(arg0) > 0)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetInt(arg0) > VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetInt(arg0) > VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                break;
-            }
-            return ret;
+            Logger::Error("Type Error: Argument 2 of function 'At' must be of type 'int'.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        VarInt i = VarGetInt(arg1);
+
+        if (i < 0)
+        {
+            Logger::Error("Runtime Error: Argument 2 of function 'At' must be a positive integer.", {});
+            errored = true;
+            return NIL_VALUE;
         }
-        case VALUE_TYPE::FLOAT:
+
+        if (VarType(arg0) == VALUE_TYPE::ARRAY || VarType(arg0) == VALUE_TYPE::TYPED_ARRAY)
         {
-            switch (arg1.type)
+            if (static_cast<uint64_t>(i) >= VarArraySize(arg0))
             {
-            case VALUE_TYPE::NIL:
-                if (VarGetFloat(arg0) > 0)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetFloat(arg0) > VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetFloat(arg0) > VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
+                Logger::Error("Runtime Error: Tried accessing element outside of array bounds using 'At' function.", {});
+                errored = true;
+                return NIL_VALUE;
             }
-            return ret;
+
+            return VarArrayAt(arg0, static_cast<size_t>(i));
         }
-        case VALUE_TYPE::NIL:
+        else if (VarType(arg0) == VALUE_TYPE::STRING)
         {
-            switch (arg1.type)
+            std::string_view s = VarGetString(arg0);
+
+            if (static_cast<uint64_t>(i) >= s.length())
             {
-            case VALUE_TYPE::NIL:
-                return ret;
-            case VALUE_TYPE::INT:
-                if (0LL > VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (0.0 > VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
+                Logger::Error("Runtime Error: Tried accessing element outside of string bounds using 'At' function.", {});
+                errored = true;
+                return NIL_VALUE;
             }
-            return ret;
-        }
-        default:
-            Logger::Error("Type Error: Greater function only handles strings, ints, floats or null.", {});
-            errored = true;
-            return ret;
+
+            return VarMakeInt(static_cast<VarInt>(s[static_cast<size_t>(i)]));
         }
+        return NIL_VALUE;
     }
 
-    Variant Lesser(std::vector<Variant> args, bool &errored)
+    // Returns the array with element 'i' replaced, written in place only by 'fetch a, SetAt, a, ...'.
+    Variant SetAt(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::INT,
-            .flags = {},
-            .d64 = 0,
-        };
-
-        if (args.size() < 2)
+        if (args_count != 3)
         {
-            Logger::Error("Syntax Error: Equals function takes 2 arguments.", {});
+            Logger::Error("Syntax Error: 'SetAt' function takes 3 arguments.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        Variant arg0 = args.at(0);
-        Variant arg1 = args.at(1);
-
-        switch (arg0.type)
-        {
-        case VALUE_TYPE::INT:
+        if ((VarType(args[0]) != VALUE_TYPE::ARRAY && VarType(args[0]) != VALUE_TYPE::TYPED_ARRAY) || VarType(args[1]) != VALUE_TYPE::INT)
         {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetInt(arg0) < 0)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetInt(arg0) < VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetInt(arg0) < VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                break;
-            }
-            return ret;
+            Logger::Error("Type Error: 'SetAt' takes an array, an int index and a value.", {});
+            errored = true;
+            return NIL_VALUE;
         }
-        case VALUE_TYPE::FLOAT:
+
+        VarInt i = VarGetInt(args[1]);
+        if (i < 0 || static_cast<uint64_t>(i) >= VarArraySize(args[0]))
         {
-            switch (arg1.type)
-            {
-            case VALUE_TYPE::NIL:
-                if (VarGetFloat(arg0) < 0)
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::INT:
-                if (VarGetFloat(arg0) < VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (VarGetFloat(arg0) < VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
-            }
-            return ret;
+            Logger::Error("Runtime Error: Tried setting element outside of array bounds using 'SetAt' function.", {});
+            errored = true;
+            return NIL_VALUE;
         }
-        case VALUE_TYPE::NIL:
+
+        if (VarType(args[0]) == VALUE_TYPE::TYPED_ARRAY)
         {
-            switch (arg1.type)
+            if (!FitsElement(VarGetTypedArray(args[0]), args[2]))
             {
-            case VALUE_TYPE::NIL:
-                return ret;
-            case VALUE_TYPE::INT:
-                if (0LL < VarGetInt(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            case VALUE_TYPE::FLOAT:
-                if (0.0 < VarGetFloat(arg1))
-                {
-                    ret.d64 = 1LL;
-                    return ret;
-                }
-                return ret;
-            default:
-                return ret;
+                Logger::Error("Type Error: Value of function 'SetAt' does not match the element type of the typed array.", {});
+                errored = true;
+                return NIL_VALUE;
             }
+
+            Variant ret = WritableArg(args[0]);
+            TypedArray &a = VarMutableTypedArray(ret);
+            if (a.elem == ELEM_TYPE::INT)
+                a.ints[static_cast<size_t>(i)] = VarGetInt(args[2]);
+            else
+                a.floats[static_cast<size_t>(i)] = NumberAsFloat(args[2]);
             return ret;
         }
-        default:
-            Logger::Error("Type Error: Lesser function only handles strings, ints, floats or null.", {});
-            errored = true;
-            return ret;
-        }
+
+        // Promoted before the array is fetched, promoting may allocate.
+        Variant value = VarPromoted(args[2]);
+        Variant ret = WritableArg(args[0]);
+        VarMutableArray(ret)[static_cast<size_t>(i)] = value;
+        return ret;
     }
 
-    Variant Len(std::vector<Variant> args, bool &errored)
+    // Returns the array with 'value' appended, written in place only by 'fetch a, Push, a, ...'.
+    Variant Push(const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0ULL,
-        };
-
-        if (args.size() < 1)
+        if (args_count != 2)
         {
-            Logger::Error("Syntax Error: 'Len' function takes 1 argument.", {});
+            Logger::Error("Syntax Error: 'Push' function takes 2 arguments.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        Variant arg0 = args.at(0);
-
-        if (arg0.type != VALUE_TYPE::ARRAY && arg0.type != VALUE_TYPE::STRING)
+        if (VarType(args[0]) != VALUE_TYPE::ARRAY && VarType(args[0]) != VALUE_TYPE::TYPED_ARRAY)
         {
-            Logger::Error("Type Error: Argument 1 of function 'Len' must be of type 'array' or 'string'.", {});
+            Logger::Error("Type Error: Argument 1 of function 'Push' must be of type 'array'.", {});
             errored = true;
-            return ret;
+            return NIL_VALUE;
         }
 
-        size_t size = 0ULL;
-
-        if (arg0.type == VALUE_TYPE::ARRAY)
+        if (VarType(args[0]) == VALUE_TYPE::TYPED_ARRAY)
         {
-            size = Memory::arrays.at(arg0.d64).size();
-        }
-        else if (arg0.type == VALUE_TYPE::STRING)
-        {
-            size = Memory::strings.at(arg0.d64).length();
-        }
+            if (!FitsElement(VarGetTypedArray(args[0]), args[1]))
+            {
+                Logger::Error("Type Error: Value of function 'Push' does not match the element type of the typed array.", {});
+                errored = true;
+                return NIL_VALUE;
+            }
 
-        if (size > static_cast<uint64_t>(INT64_MAX))
-        {
-            size = INT64_MAX;
+            Variant ret = WritableArg(args[0]);
+            TypedArray &a = VarMutableTypedArray(ret);
+            ResizeTyped(a, a.size() + 1, args[1]);
+            return ret;
         }
-        ret.type = VALUE_TYPE::INT;
-        ret.d64 = static_cast<VarInt>(size);
+
+        Variant value = VarPromoted(args[1]);
+        Variant ret = WritableArg(args[0]);
+        VarMutableArray(ret);
+        Memory::AppendToArray(VarGetHandle(ret), value);
         return ret;
     }
 
-    Variant At(std::vector<Variant> args, bool &errored)
+#if GVS_COUNT_ALLOCATIONS
+    // Test hook of alloc_tests.gvs, only in builds counting allocations.
+    Variant Allocations([[maybe_unused]] const Variant *args, size_t args_count, bool &errored)
     {
-        Variant ret{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0ULL,
-        };
-
-        if (args.size() < 2)
+        if (args_count > 0)
         {
-            Logger::Error("Syntax Error: 'At' function takes 2 arguments.", {});
+            Logger::Error("Syntax Error: 'Allocations' function takes no arguments.", {});
             errored = true;
-            return ret;
+            return VarMakeInt(0);
         }
 
-        Variant arg0 = args.at(0);
-        Variant arg1 = args.at(1);
+        return VarMakeInt(static_cast<VarInt>(Memory::heap_allocations));
+    }
+#endif
 
-        if (arg0.type != VALUE_TYPE::ARRAY && arg0.type != VALUE_TYPE::STRING)
+    // Reads one counter of the string/array store accounting, like 'MemStats, "string_bytes"'.
+    Variant MemStats(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count != 1 || VarType(args[0]) != VALUE_TYPE::STRING)
         {
-            Logger::Error("Type Error: Argument 1 of function 'At' must be of type 'array' or 'string'.", {});
+            Logger::Error("Syntax Error: 'MemStats' function takes 1 argument of type string.", {});
             errored = true;
-            return ret;
-        }
+            return VarMakeInt(0);
+        }
+
+        std::string_view key = VarGetString(args[0]);
+        static const std::unordered_map<std::string_view, const uint64_t *> counters{
+            {"strings", &Memory::string_stats.live},
+            {"string_bytes", &Memory::string_stats.bytes},
+            {"peak_strings", &Memory::string_stats.peak_live},
+            {"peak_string_bytes", &Memory::string_stats.peak_bytes},
+            {"arrays", &Memory::array_stats.live},
+            {"array_bytes", &Memory::array_stats.bytes},
+            {"peak_arrays", &Memory::array_stats.peak_live},
+            {"peak_array_bytes", &Memory::array_stats.peak_bytes},
+            {"maps", &Memory::map_stats.live},
+            {"map_bytes", &Memory::map_stats.bytes},
+            {"structs", &Memory::struct_stats.live},
+            {"struct_bytes", &Memory::struct_stats.bytes},
+            {"slices", &Memory::slice_stats.live},
+            {"temp_strings", &Memory::temp_allocations},
+            {"peak_arena_bytes", &Memory::arena_peak_bytes},
+        };
 
-        if (arg1.type != VALUE_TYPE::INT)
+        auto it = counters.find(key);
+        if (it == counters.end())
         {
-            Logger::Error("Type Error: Argument 2 of function 'At' must be of type 'int'.", {});
+            Logger::Error("Value Error: 'MemStats' has no counter named", {std::string(key)});
             errored = true;
-            return ret;
+            return VarMakeInt(0);
         }
 
-        VarInt i = VarGetInt(arg1);
+        return VarMakeInt(static_cast<VarInt>(*it->second));
+    }
 
-        if (i < 0)
+    // Prints the newest entries of the execution trace to stderr, all of them without an argument.
+    Variant TraceDump(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count > 1 || (args_count == 1 && VarType(args[0]) != VALUE_TYPE::INT))
         {
-            Logger::Error("Runtime Error: Argument 2 of function 'At' must be a positive integer.", {});
+            Logger::Error("Syntax Error: 'TraceDump' function takes an optional int argument.", {});
             errored = true;
-            return ret;
+            return VarMakeInt(0);
         }
 
-        if (arg0.type == VALUE_TYPE::ARRAY)
-        {
-            VarArray arr = Memory::arrays.at(arg0.d64);
+        size_t count = Trace::CAPACITY;
+        if (args_count == 1)
+            count = VarGetInt(args[0]) > 0 ? static_cast<size_t>(VarGetInt(args[0])) : 0;
 
-            if (static_cast<uint64_t>(i) >= arr.size())
-            {
-                Logger::Error("Runtime Error: Tried accessing element outside of array bounds using 'At' function.", {});
-                errored = true;
-                return ret;
-            }
+        return VarMakeInt(static_cast<VarInt>(Trace::Dump(std::cerr, count)));
+    }
 
-            ret = arr.at(i);
-            return ret;
-        }
-        else if (arg0.type == VALUE_TYPE::STRING)
+    // Text 'TraceDump' would print, so scripts can check the trace without writing to stderr.
+    Variant TraceText(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count > 1 || (args_count == 1 && VarType(args[0]) != VALUE_TYPE::INT))
         {
-            std::string s = Memory::strings.at(arg0.d64);
+            Logger::Error("Syntax Error: 'TraceText' function takes an optional int argument.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
 
-            if (static_cast<uint64_t>(i) >= s.length())
-            {
-                Logger::Error("Runtime Error: Tried accessing element outside of string bounds using 'At' function.", {});
-                errored = true;
-                return ret;
-            }
+        size_t count = Trace::CAPACITY;
+        if (args_count == 1)
+            count = VarGetInt(args[0]) > 0 ? static_cast<size_t>(VarGetInt(args[0])) : 0;
 
-            ret.type = VALUE_TYPE::INT;
-            ret.d64 = static_cast<VarInt>(s.at(i));
-            return ret;
-        }
-        return ret;
+        std::ostringstream text;
+        Trace::Dump(text, count);
+        return VarMakeString(text.str());
     }
 
-    const std::unordered_map<std::string, std::function<Variant(std::vector<Variant> &, bool &)>> BUILTIN_MAP{
+    const std::unordered_map<std::string, BuiltinFunc> BUILTIN_MAP{
         {"Print", Print},
+        {"Flush", Flush},
         {"Panic", Panic},
         {"GetLine", GetLine},
         {"GetChar", GetChar},
         {"ToString", ToString},
+        {"FormatNumber", FormatNumber},
         {"StrFromChar", StrFromChar},
         {"AddI", AddI},
         {"AddF", AddF},
@@ -995,17 +643,58 @@ namespace BuiltinFuncs
         {"Greater", Greater},
         {"Lesser", Lesser},
         {"At", At},
+        {"SetAt", SetAt},
+        {"Push", Push},
         {"Len", Len},
+#if GVS_COUNT_ALLOCATIONS
+        {"Allocations", Allocations},
+#endif
+        {"TraceDump", TraceDump},
+        {"TraceText", TraceText},
+        {"MemStats", MemStats},
+        {"IntArray", IntArray},
+        {"FloatArray", FloatArray},
+        {"ToTyped", ToTyped},
+        {"Sum", Sum},
+        {"Min", Min},
+        {"Max", Max},
+        {"Dot", Dot},
+        {"AddArrays", AddArrays},
+        {"Scale", Scale},
+        {"Fill", Fill},
+        {"IndexOf", IndexOf},
+        {"MapNew", MapNew},
+        {"MapGet", MapGet},
+        {"MapSet", MapSet},
+        {"MapHas", MapHas},
+        {"MapDel", MapDel},
+        {"MapKeys", MapKeys},
+        {"MapLen", MapLen},
+        {"Substr", Substr},
+        {"Slice", Slice},
+        {"Find", Find},
+        {"Contains", Contains},
+        {"StartsWith", StartsWith},
+        {"EndsWith", EndsWith},
+        {"Split", Split},
     };
 
-    Variant CallBuiltIn(const std::string name, std::vector<Variant> &args, bool &errored)
+    Variant CallBuiltIn(const std::string &name, const Variant *args, size_t args_count, bool &errored)
     {
-        auto func = BUILTIN_MAP.at(name);
-        return func(args, errored);
+        return BUILTIN_MAP.at(name)(args, args_count, errored);
     }
 
     bool IsBuiltIn(const std::string name)
     {
         return Helper::UnorderedMapHasKey(BUILTIN_MAP, name);
     }
+
+    // Native pointer of a builtin, null when there is no builtin with that name.
+    BuiltinFunc FindBuiltIn(const std::string &name)
+    {
+        auto it = BUILTIN_MAP.find(name);
+        if (it == BUILTIN_MAP.end())
+            return nullptr;
+        return it->second;
+    }
 }
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../types/variant.hpp"
+#include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "../memory/memory.hpp"
+#include "../registers/registers.hpp"
+
+// Small value helpers shared by the builtins.
+namespace BuiltinFuncs
+{
+    inline bool IsNumber(const Variant &v)
+    {
+        return VarType(v) == VALUE_TYPE::INT || VarType(v) == VALUE_TYPE::FLOAT;
+    }
+
+    inline VarFloat NumberAsFloat(const Variant &v)
+    {
+        return VarType(v) == VALUE_TYPE::INT ? static_cast<VarFloat>(VarGetInt(v)) : VarGetFloat(v);
+    }
+
+    // First argument of a builtin which writes it and returns the result, as Push does.
+    // Unless the caller stores the result over that argument ('fetch a, Push, a, 1'), its variable
+    // keeps the handle, so the handle counts as shared and the write goes to a copy.
+    inline Variant WritableArg(const Variant &v)
+    {
+        Variant ret = v;
+        if (!Registers::first_arg_owned)
+            Memory::ShareArray(ret);
+        Registers::ret_unshared = true;
+        return ret;
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../logger/logger.hpp"
+#include "../types/variant.hpp"
+#include "../memory/memory.hpp"
+#include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "builtin_values.hpp"
+
+// Builtins of the maps, keys are ints or strings.
+// Writes follow the arrays: they return the handle and copy the table first unless the result replaces it.
+namespace BuiltinFuncs
+{
+    namespace
+    {
+        bool ExpectMap(const Variant *args, size_t args_count, size_t min_count, size_t max_count, const char *name, bool &errored)
+        {
+            if (args_count < min_count || args_count > max_count || VarType(args[0]) != VALUE_TYPE::MAP)
+            {
+                Logger::Error("Syntax Error: wrong arguments for function", {name, "which takes a map first."});
+                errored = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool KeyOf(const Variant &v, bool insert, const char *name, uint64_t &key, bool &errored)
+        {
+            if (VarType(v) != VALUE_TYPE::INT && VarType(v) != VALUE_TYPE::STRING)
+            {
+                Logger::Error("Type Error: keys of function", {name, "must be of type int or string."});
+                errored = true;
+                return false;
+            }
+            return VarMapKey(v, insert, key);
+        }
+    }
+
+    Variant MapNew([[maybe_unused]] const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count > 0)
+        {
+            Logger::Error("Syntax Error: 'MapNew' function takes no arguments.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+        return VarMakeHandle(VALUE_TYPE::MAP, Memory::AllocMap(VarMap{}));
+    }
+
+    // Value stored under the key, the third argument or null when it is absent.
+    Variant MapGet(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectMap(args, args_count, 2, 3, "MapGet", errored))
+            return NIL_VALUE;
+
+        Variant fallback = args_count == 3 ? args[2] : NIL_VALUE;
+
+        uint64_t key = 0;
+        if (!KeyOf(args[1], false, "MapGet", key, errored))
+            return fallback;
+
+        const VarMap::Slot *slot = VarGetMap(args[0]).Find(key);
+        if (!slot)
+            return fallback;
+        return slot->value;
+    }
+
+    Variant MapHas(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectMap(args, args_count, 2, 2, "MapHas", errored))
+            return NIL_VALUE;
+
+        uint64_t key = 0;
+        bool found = KeyOf(args[1], false, "MapHas", key, errored) && VarGetMap(args[0]).Find(key);
+        return VarMakeInt(found ? 1 : 0);
+    }
+
+    Variant MapSet(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectMap(args, args_count, 3, 3, "MapSet", errored))
+            return NIL_VALUE;
+
+        // Key and value first, both may allocate.
+        uint64_t key = 0;
+        if (!KeyOf(args[1], true, "MapSet", key, errored))
+            return NIL_VALUE;
+        Variant value = VarPromoted(args[2]);
+
+        Variant ret = WritableArg(args[0]);
+        VarMap &m = VarMutableMap(ret);
+        size_t old_bytes = Memory::MapBytes(m);
+        m.Set(key, value);
+        Memory::ReaccountMap(old_bytes, Memory::MapBytes(m));
+        return ret;
+    }
+
+    // Removing an absent key is not an error.
+    Variant MapDel(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectMap(args, args_count, 2, 2, "MapDel", errored))
+            return NIL_VALUE;
+
+        Variant ret = WritableArg(args[0]);
+        uint64_t key = 0;
+        if (!KeyOf(args[1], false, "MapDel", key, errored) || !VarGetMap(ret).Find(key))
+            return ret;
+
+        VarMutableMap(ret).Erase(key);
+        return ret;
+    }
+
+    // Array of the keys, in no particular order.
+    Variant MapKeys(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectMap(args, args_count, 1, 1, "MapKeys", errored))
+            return NIL_VALUE;
+
+        VarArray keys{};
+        const VarMap &m = VarGetMap(args[0]);
+        keys.reserve(m.size());
+        m.ForEach([&keys](const VarMap::Slot &slot)
+                  { keys.push_back(Variant{slot.key}); });
+        return VarMakeHandle(VALUE_TYPE::ARRAY, Memory::AllocArray(std::move(keys)));
+    }
+
+    Variant MapLen(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectMap(args, args_count, 1, 1, "MapLen", errored))
+            return NIL_VALUE;
+        return VarMakeInt(static_cast<VarInt>(VarGetMap(args[0]).size()));
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "../logger/logger.hpp"
+#include "../types/variant.hpp"
+#include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "builtin_values.hpp"
+
+// Number to text conversions of ToString, Print and FormatNumber, done with std::to_chars into a
+// caller buffer so they take no locale and allocate nothing.
+namespace BuiltinFuncs
+{
+    // Holds any int and the shortest form of any float.
+    const size_t NUMBER_TEXT_SIZE = 32;
+    const VarInt MAX_PRECISION = 32;
+
+    std::string_view FormatInt(VarInt i, char *buf)
+    {
+        std::to_chars_result r = std::to_chars(buf, buf + NUMBER_TEXT_SIZE, i);
+        return std::string_view(buf, static_cast<size_t>(r.ptr - buf));
+    }
+
+    // Shortest text which reads back as the same float, with '.0' when it would read as an int.
+    std::string_view FormatFloat(VarFloat f, char *buf)
+    {
+        std::to_chars_result r = std::to_chars(buf, buf + NUMBER_TEXT_SIZE - 2, f);
+        std::string_view text(buf, static_cast<size_t>(r.ptr - buf));
+        if (text.find_first_not_of("-0123456789") == std::string_view::npos)
+        {
+            *r.ptr++ = '.';
+            *r.ptr++ = '0';
+            text = std::string_view(buf, static_cast<size_t>(r.ptr - buf));
+        }
+        return text;
+    }
+
+    // Text of a value as ToString and Print show it, numbers are written to 'buf'.
+    // The view of a string points into 'v'.
+    std::string_view FormatValue(const Variant &v, char *buf)
+    {
+        switch (VarType(v))
+        {
+        case VALUE_TYPE::STRING:
+            return VarGetString(v);
+        case VALUE_TYPE::INT:
+            return FormatInt(VarGetInt(v), buf);
+        case VALUE_TYPE::FLOAT:
+            return FormatFloat(VarGetFloat(v), buf);
+        case VALUE_TYPE::NIL:
+            return "null";
+        default:
+            return "";
+        }
+    }
+
+    // Number as text, shortest like ToString or with a fixed count of decimals: 'FormatNumber, 2.5, 3' is "2.500".
+    Variant FormatNumber(const Variant *args, size_t args_count, bool &errored)
+    {
+        bool precision_ok = args_count == 1 || (args_count == 2 && VarType(args[1]) == VALUE_TYPE::INT &&
+                                                VarGetInt(args[1]) >= 0 && VarGetInt(args[1]) <= MAX_PRECISION);
+        if (args_count < 1 || !IsNumber(args[0]) || !precision_ok)
+        {
+            Logger::Error("Syntax Error: 'FormatNumber' function takes a number and an optional count of decimals from 0 to",
+                          {std::to_string(MAX_PRECISION) + "."});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        char buf[NUMBER_TEXT_SIZE];
+        if (args_count == 1)
+            return VarCopyString(FormatValue(args[0], buf));
+
+        int precision = static_cast<int>(VarGetInt(args[1]));
+        std::string text;
+        if (VarType(args[0]) == VALUE_TYPE::INT)
+        {
+            // Ints keep all their digits, the decimals are zeros.
+            text = FormatInt(VarGetInt(args[0]), buf);
+            if (precision)
+                text += "." + std::string(static_cast<size_t>(precision), '0');
+            return VarMakeString(std::move(text));
+        }
+
+        // Fixed notation of the largest floats takes over 300 digits.
+        text.resize(NUMBER_TEXT_SIZE + 320);
+        std::to_chars_result r = std::to_chars(text.data(), text.data() + text.size(), VarGetFloat(args[0]),
+                                               std::chars_format::fixed, precision);
+        text.resize(static_cast<size_t>(r.ptr - text.data()));
+        return VarMakeString(std::move(text));
+    }
+}
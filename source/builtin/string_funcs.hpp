@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "../logger/logger.hpp"
+#include "../types/variant.hpp"
+#include "../types/string_slice.hpp"
+#include "../memory/memory.hpp"
+#include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "../simd/search.hpp"
+#include "builtin_values.hpp"
+
+// Builtins which cut and search strings.
+// Parts of a stored string are slices sharing its characters, so cutting a long string copies nothing.
+// Parts which fit inline, and parts of strings in the frame arena, are copied.
+namespace BuiltinFuncs
+{
+    namespace
+    {
+        // Characters [offset, offset + size) of the string 'source', which must hold them.
+        Variant MakeSlice(const Variant &source, size_t offset, size_t size)
+        {
+            std::string_view s = VarGetString(source);
+            if (offset == 0 && size == s.size() && !VarIsTempString(source))
+                return source;
+            if (size <= INLINE_STRING_CAPACITY || VarIsTempString(source) || VarIsInlineString(source))
+                return VarCopyString(s.substr(offset, size));
+
+            // A slice of a slice points at the original string.
+            if (VarIsSliceString(source))
+            {
+                const StringSlice &parent = VarGetSlice(source);
+                return VarMakeSlice(StringSlice{.parent = parent.parent, .offset = parent.offset + offset, .size = size});
+            }
+            return VarMakeSlice(StringSlice{.parent = VarGetHandle(source), .offset = offset, .size = size});
+        }
+
+        bool ExpectString(const Variant *args, size_t args_count, size_t min_count, size_t max_count, const char *name, bool &errored)
+        {
+            if (args_count < min_count || args_count > max_count || VarType(args[0]) != VALUE_TYPE::STRING)
+            {
+                Logger::Error("Syntax Error: wrong arguments for function", {name, "which takes a string first."});
+                errored = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool ExpectStringArg(const Variant &v, const char *name, bool &errored)
+        {
+            if (VarType(v) != VALUE_TYPE::STRING)
+            {
+                Logger::Error("Type Error: Argument 2 of function", {name, "must be of type string."});
+                errored = true;
+                return false;
+            }
+            return true;
+        }
+
+        bool ExpectIndex(const Variant &v, const char *name, bool &errored)
+        {
+            if (VarType(v) != VALUE_TYPE::INT)
+            {
+                Logger::Error("Type Error: indices of function", {name, "must be of type int."});
+                errored = true;
+                return false;
+            }
+            return true;
+        }
+
+        // Index into a string of 'size' characters, negative ones count from the end. Clamped to [0, size].
+        size_t ClampIndex(VarInt i, size_t size)
+        {
+            VarInt n = static_cast<VarInt>(size);
+            if (i < 0)
+                i += n;
+            return static_cast<size_t>(i < 0 ? 0 : (i > n ? n : i));
+        }
+    }
+
+    // Substr(s, start[, count]): 'count' characters from 'start', or the rest of the string.
+    Variant Substr(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 3, "Substr", errored) || !ExpectIndex(args[1], "Substr", errored) ||
+            (args_count == 3 && !ExpectIndex(args[2], "Substr", errored)))
+            return NIL_VALUE;
+        if (VarGetInt(args[1]) < 0 || (args_count == 3 && VarGetInt(args[2]) < 0))
+        {
+            Logger::Error("Runtime Error: start and count of function 'Substr' must be positive integers.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        size_t size = VarGetString(args[0]).size();
+        size_t start = ClampIndex(VarGetInt(args[1]), size);
+        size_t count = size - start;
+        if (args_count == 3 && static_cast<uint64_t>(VarGetInt(args[2])) < count)
+            count = static_cast<size_t>(VarGetInt(args[2]));
+        return MakeSlice(args[0], start, count);
+    }
+
+    // Slice(s, start[, end]): characters [start, end), negative indices count from the end.
+    Variant Slice(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 3, "Slice", errored) || !ExpectIndex(args[1], "Slice", errored) ||
+            (args_count == 3 && !ExpectIndex(args[2], "Slice", errored)))
+            return NIL_VALUE;
+
+        size_t size = VarGetString(args[0]).size();
+        size_t start = ClampIndex(VarGetInt(args[1]), size);
+        size_t end = args_count == 3 ? ClampIndex(VarGetInt(args[2]), size) : size;
+        return MakeSlice(args[0], start, end > start ? end - start : 0);
+    }
+
+    // Find(s, needle[, from]): index of the first 'needle' at or after 'from', -1 when there is none.
+    Variant Find(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 3, "Find", errored) || !ExpectStringArg(args[1], "Find", errored) ||
+            (args_count == 3 && !ExpectIndex(args[2], "Find", errored)))
+            return NIL_VALUE;
+
+        std::string_view s = VarGetString(args[0]);
+        size_t from = args_count == 3 ? ClampIndex(VarGetInt(args[2]), s.size()) : 0;
+        size_t pos = Simd::Find(s, VarGetString(args[1]), from);
+        return VarMakeInt(pos == std::string_view::npos ? -1 : static_cast<VarInt>(pos));
+    }
+
+    Variant Contains(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 2, "Contains", errored) || !ExpectStringArg(args[1], "Contains", errored))
+            return NIL_VALUE;
+        return VarMakeInt(Simd::Find(VarGetString(args[0]), VarGetString(args[1])) != std::string_view::npos ? 1 : 0);
+    }
+
+    Variant StartsWith(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 2, "StartsWith", errored) || !ExpectStringArg(args[1], "StartsWith", errored))
+            return NIL_VALUE;
+        return VarMakeInt(VarGetString(args[0]).starts_with(VarGetString(args[1])) ? 1 : 0);
+    }
+
+    Variant EndsWith(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 2, "EndsWith", errored) || !ExpectStringArg(args[1], "EndsWith", errored))
+            return NIL_VALUE;
+        return VarMakeInt(VarGetString(args[0]).ends_with(VarGetString(args[1])) ? 1 : 0);
+    }
+
+    // Split(s, sep): array of the parts between the separators, which must not be empty.
+    Variant Split(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectString(args, args_count, 2, 2, "Split", errored) || !ExpectStringArg(args[1], "Split", errored))
+            return NIL_VALUE;
+        if (VarGetString(args[1]).empty())
+        {
+            Logger::Error("Runtime Error: separator of function 'Split' must not be empty.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        // The parts go into an array, so a string in the frame arena moves to the store once
+        // and the parts slice it instead of each being copied.
+        Variant source = args[0];
+        VarPromote(source);
+        std::string sep(VarGetString(args[1]));
+
+        VarArray parts{};
+        size_t start = 0;
+        for (;;)
+        {
+            // Read again after every part, storing one may move the characters of a short string.
+            size_t pos = Simd::Find(VarGetString(source), sep, start);
+            if (pos == std::string_view::npos)
+                break;
+            parts.push_back(VarPromoted(MakeSlice(source, start, pos - start)));
+            start = pos + sep.size();
+        }
+        parts.push_back(VarPromoted(MakeSlice(source, start, VarGetString(source).size() - start)));
+        return VarMakeHandle(VALUE_TYPE::ARRAY, Memory::AllocArray(std::move(parts)));
+    }
+}
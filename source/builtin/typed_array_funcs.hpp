@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "../logger/logger.hpp"
+#include "../types/variant.hpp"
+#include "../types/typed_array.hpp"
+#include "../memory/memory.hpp"
+#include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "../simd/kernels.hpp"
+#include "builtin_values.hpp"
+
+// Builtins of the typed arrays, the bulk ones run the kernels in Simd.
+// Writes follow the arrays: they return the handle and copy the buffer first when it is shared.
+namespace BuiltinFuncs
+{
+    namespace
+    {
+        Variant MakeTypedArray(TypedArray a)
+        {
+            return VarMakeHandle(VALUE_TYPE::TYPED_ARRAY, Memory::AllocTypedArray(std::move(a)));
+        }
+
+        // Checks that 'v' can be stored in 'a', ints only go into int arrays.
+        bool FitsElement(const TypedArray &a, const Variant &v)
+        {
+            return a.elem == ELEM_TYPE::INT ? VarType(v) == VALUE_TYPE::INT : IsNumber(v);
+        }
+
+        // Resizes 'a' to 'size' elements of 'v', keeping the store accounting in step.
+        void ResizeTyped(TypedArray &a, size_t size, const Variant &v)
+        {
+            size_t old_bytes = Memory::TypedArrayBytes(a);
+            if (a.elem == ELEM_TYPE::INT)
+                a.ints.resize(size, VarGetInt(v));
+            else
+                a.floats.resize(size, NumberAsFloat(v));
+            Memory::ReaccountArray(old_bytes, Memory::TypedArrayBytes(a));
+        }
+
+        Variant NewTyped(ELEM_TYPE elem, const char *name, const Variant *args, size_t args_count, bool &errored)
+        {
+            if (args_count < 1 || args_count > 2 || VarType(args[0]) != VALUE_TYPE::INT || VarGetInt(args[0]) < 0)
+            {
+                Logger::Error("Syntax Error: function", {name, "takes a size of type int and an optional fill value."});
+                errored = true;
+                return NIL_VALUE;
+            }
+
+            TypedArray a{.elem = elem, .ints = {}, .floats = {}};
+            Variant fill = elem == ELEM_TYPE::INT ? VarMakeInt(0) : VarMakeFloat(0.0);
+            if (args_count == 2)
+                fill = args[1];
+            if (!FitsElement(a, fill))
+            {
+                Logger::Error("Type Error: fill value of function", {name, "does not match the element type."});
+                errored = true;
+                return NIL_VALUE;
+            }
+
+            size_t size = static_cast<size_t>(VarGetInt(args[0]));
+            if (elem == ELEM_TYPE::INT)
+                a.ints.assign(size, VarGetInt(fill));
+            else
+                a.floats.assign(size, NumberAsFloat(fill));
+            return MakeTypedArray(std::move(a));
+        }
+
+        bool ExpectTyped(const Variant *args, size_t args_count, size_t expected, const char *name, bool &errored)
+        {
+            if (args_count != expected || VarType(args[0]) != VALUE_TYPE::TYPED_ARRAY)
+            {
+                Logger::Error("Syntax Error: function", {name, "takes", std::to_string(expected), "arguments, the first of type typed array."});
+                errored = true;
+                return false;
+            }
+            return true;
+        }
+
+        // Both typed arrays must have the same element type and size.
+        bool ExpectMatching(const TypedArray &a, const TypedArray &b, const char *name, bool &errored)
+        {
+            if (a.elem != b.elem || a.size() != b.size())
+            {
+                Logger::Error("Type Error: arguments of function", {name, "must be typed arrays of the same type and size."});
+                errored = true;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    Variant IntArray(const Variant *args, size_t args_count, bool &errored)
+    {
+        return NewTyped(ELEM_TYPE::INT, "IntArray", args, args_count, errored);
+    }
+
+    Variant FloatArray(const Variant *args, size_t args_count, bool &errored)
+    {
+        return NewTyped(ELEM_TYPE::FLOAT, "FloatArray", args, args_count, errored);
+    }
+
+    // Converts an array of numbers, a float array when any element is a float.
+    Variant ToTyped(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (args_count != 1 || (VarType(args[0]) != VALUE_TYPE::ARRAY && VarType(args[0]) != VALUE_TYPE::TYPED_ARRAY))
+        {
+            Logger::Error("Syntax Error: 'ToTyped' function takes 1 argument of type array.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        if (VarType(args[0]) == VALUE_TYPE::TYPED_ARRAY)
+        {
+            return args[0];
+        }
+
+        const VarArray &source = VarGetArray(args[0]);
+        TypedArray a{.elem = ELEM_TYPE::INT, .ints = {}, .floats = {}};
+        for (const Variant &v : source)
+        {
+            if (!IsNumber(v))
+            {
+                Logger::Error("Type Error: 'ToTyped' only converts arrays of ints and floats.", {});
+                errored = true;
+                return NIL_VALUE;
+            }
+            if (VarType(v) == VALUE_TYPE::FLOAT)
+                a.elem = ELEM_TYPE::FLOAT;
+        }
+
+        if (a.elem == ELEM_TYPE::INT)
+        {
+            a.ints.reserve(source.size());
+            for (const Variant &v : source)
+                a.ints.push_back(VarGetInt(v));
+        }
+        else
+        {
+            a.floats.reserve(source.size());
+            for (const Variant &v : source)
+                a.floats.push_back(NumberAsFloat(v));
+        }
+        return MakeTypedArray(std::move(a));
+    }
+
+    Variant Sum(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 1, "Sum", errored))
+            return NIL_VALUE;
+
+        const TypedArray &a = VarGetTypedArray(args[0]);
+        if (a.elem == ELEM_TYPE::INT)
+            return VarMakeInt(Simd::SumInt(a.ints.data(), a.ints.size()));
+        return VarMakeFloat(Simd::SumFloat(a.floats.data(), a.floats.size()));
+    }
+
+    Variant Min(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 1, "Min", errored))
+            return NIL_VALUE;
+
+        const TypedArray &a = VarGetTypedArray(args[0]);
+        if (!a.size())
+        {
+            Logger::Error("Runtime Error: 'Min' of an empty array.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+        if (a.elem == ELEM_TYPE::INT)
+            return VarMakeInt(Simd::MinInt(a.ints.data(), a.ints.size()));
+        return VarMakeFloat(Simd::MinFloat(a.floats.data(), a.floats.size()));
+    }
+
+    Variant Max(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 1, "Max", errored))
+            return NIL_VALUE;
+
+        const TypedArray &a = VarGetTypedArray(args[0]);
+        if (!a.size())
+        {
+            Logger::Error("Runtime Error: 'Max' of an empty array.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+        if (a.elem == ELEM_TYPE::INT)
+            return VarMakeInt(Simd::MaxInt(a.ints.data(), a.ints.size()));
+        return VarMakeFloat(Simd::MaxFloat(a.floats.data(), a.floats.size()));
+    }
+
+    Variant Dot(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 2, "Dot", errored))
+            return NIL_VALUE;
+        if (VarType(args[1]) != VALUE_TYPE::TYPED_ARRAY)
+        {
+            Logger::Error("Type Error: Argument 2 of function 'Dot' must be of type typed array.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        const TypedArray &a = VarGetTypedArray(args[0]);
+        const TypedArray &b = VarGetTypedArray(args[1]);
+        if (!ExpectMatching(a, b, "Dot", errored))
+            return NIL_VALUE;
+        if (a.elem == ELEM_TYPE::INT)
+            return VarMakeInt(Simd::DotInt(a.ints.data(), b.ints.data(), a.size()));
+        return VarMakeFloat(Simd::DotFloat(a.floats.data(), b.floats.data(), a.size()));
+    }
+
+    // Returns a new array holding the element-wise sums.
+    Variant AddArrays(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 2, "AddArrays", errored))
+            return NIL_VALUE;
+        if (VarType(args[1]) != VALUE_TYPE::TYPED_ARRAY)
+        {
+            Logger::Error("Type Error: Argument 2 of function 'AddArrays' must be of type typed array.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        TypedArray sum{.elem = VarGetTypedArray(args[0]).elem, .ints = {}, .floats = {}};
+        {
+            const TypedArray &a = VarGetTypedArray(args[0]);
+            const TypedArray &b = VarGetTypedArray(args[1]);
+            if (!ExpectMatching(a, b, "AddArrays", errored))
+                return NIL_VALUE;
+
+            if (a.elem == ELEM_TYPE::INT)
+            {
+                sum.ints.resize(a.size());
+                Simd::AddInt(a.ints.data(), b.ints.data(), sum.ints.data(), a.size());
+            }
+            else
+            {
+                sum.floats.resize(a.size());
+                Simd::AddFloat(a.floats.data(), b.floats.data(), sum.floats.data(), a.size());
+            }
+        }
+        return MakeTypedArray(std::move(sum));
+    }
+
+    // Multiplies every element by 'k' and returns the array, int arrays take an int factor.
+    Variant Scale(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 2, "Scale", errored))
+            return NIL_VALUE;
+        if (!FitsElement(VarGetTypedArray(args[0]), args[1]))
+        {
+            Logger::Error("Type Error: Factor of function 'Scale' does not match the element type.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        Variant ret = WritableArg(args[0]);
+        TypedArray &a = VarMutableTypedArray(ret);
+        if (a.elem == ELEM_TYPE::INT)
+            Simd::ScaleInt(a.ints.data(), a.size(), VarGetInt(args[1]));
+        else
+            Simd::ScaleFloat(a.floats.data(), a.size(), NumberAsFloat(args[1]));
+        return ret;
+    }
+
+    Variant Fill(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 2, "Fill", errored))
+            return NIL_VALUE;
+        if (!FitsElement(VarGetTypedArray(args[0]), args[1]))
+        {
+            Logger::Error("Type Error: Fill value of function 'Fill' does not match the element type.", {});
+            errored = true;
+            return NIL_VALUE;
+        }
+
+        Variant ret = WritableArg(args[0]);
+        TypedArray &a = VarMutableTypedArray(ret);
+        if (a.elem == ELEM_TYPE::INT)
+            std::fill(a.ints.begin(), a.ints.end(), VarGetInt(args[1]));
+        else
+            std::fill(a.floats.begin(), a.floats.end(), NumberAsFloat(args[1]));
+        return ret;
+    }
+
+    // Index of the first element equal to the value, -1 when there is none.
+    // Int arrays only hold ints, a float is never found in them.
+    Variant IndexOf(const Variant *args, size_t args_count, bool &errored)
+    {
+        if (!ExpectTyped(args, args_count, 2, "IndexOf", errored))
+            return NIL_VALUE;
+
+        const TypedArray &a = VarGetTypedArray(args[0]);
+        if (!IsNumber(args[1]))
+            return VarMakeInt(-1);
+        if (a.elem == ELEM_TYPE::FLOAT)
+            return VarMakeInt(Simd::IndexOfFloat(a.floats.data(), a.size(), NumberAsFloat(args[1])));
+        if (VarType(args[1]) != VALUE_TYPE::INT)
+            return VarMakeInt(-1);
+        return VarMakeInt(Simd::IndexOfInt(a.ints.data(), a.size(), VarGetInt(args[1])));
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "../logger/logger.hpp"
+
+#include "../types/error.hpp"
+#include "../types/token.hpp"
+#include "../types/variant.hpp"
+#include "../types/instructions.hpp"
+#include "../make_variant/make_variant.hpp"
+
+namespace Compiler
+{
+    // Fills inst.call_args with one value per argument in inst.args[first..].
+    // Literals are made once here, names are left null and resolved on each call.
+    Error CompileCallArguments(Instruction &inst, size_t first)
+    {
+        inst.call_args.clear();
+
+        for (size_t i = first; i < inst.args.size(); ++i)
+        {
+            Token::Token &tok = inst.args[i];
+            if (tok.type == Token::COMMA)
+                continue;
+
+            Variant v = NIL_VALUE;
+            if (tok.type != Token::NAME)
+            {
+                Error make_err = MakeVariant(v, tok);
+                if (make_err)
+                {
+                    Logger::Error("Syntax Error: invalid argument in call to function", {inst.args.at(first - 2).content, "got:", tok.content});
+                    return Error::SYNTAX;
+                }
+            }
+            inst.call_args.push_back(v);
+        }
+        return Error::OK;
+    }
+}
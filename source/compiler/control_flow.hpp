@@ -0,0 +1,187 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "../logger/logger.hpp"
+
+#include "../types/error.hpp"
+#include "../types/token.hpp"
+#include "../types/instructions.hpp"
+#include "../types/scope.hpp"
+
+namespace Compiler
+{
+    namespace
+    {
+        struct Block
+        {
+            Token::TYPE type;
+            size_t start;
+            size_t last_branch;
+            bool has_else;
+            std::vector<size_t> branches;
+            std::vector<size_t> breaks;
+            std::vector<size_t> continues;
+        };
+
+        Block *InnermostLoop(std::vector<Block> &blocks)
+        {
+            for (auto it = blocks.rbegin(); it != blocks.rend(); ++it)
+            {
+                if (it->type == Token::KEYW_WHILE || it->type == Token::KEYW_FOR)
+                    return &*it;
+            }
+            return nullptr;
+        }
+
+        size_t CountEnclosingFor(const std::vector<Block> &blocks)
+        {
+            size_t count = 0;
+            for (const Block &b : blocks)
+            {
+                if (b.type == Token::KEYW_FOR)
+                    ++count;
+            }
+            return count;
+        }
+
+        std::string LineOf(const Instruction &inst)
+        {
+            if (!inst.args.size())
+                return "?";
+            return std::to_string(inst.args.at(0).line);
+        }
+    }
+
+    // Links if/elif/else/endif chains and loop blocks of a scope with precomputed jump targets.
+    //  if/elif : jump -> next elif/else/endif when the condition is false.
+    //  elif/else : exit -> endif when reached from the end of the previous branch.
+    //  while/for : exit -> instruction after endwhile/endfor.
+    //  endwhile/endfor : jump -> while/for.
+    //  break : exit -> instruction after the loop. continue : jump -> while/endfor.
+    Error ResolveJumps(Scope &scope)
+    {
+        std::vector<Instruction> &insts = scope.instructions;
+        std::vector<Block> blocks{};
+
+        for (size_t i = 0; i < insts.size(); ++i)
+        {
+            Instruction &inst = insts[i];
+
+            switch (inst.type)
+            {
+            case Token::KEYW_IF:
+            {
+                blocks.push_back(Block{
+                    .type = Token::KEYW_IF,
+                    .start = i,
+                    .last_branch = i,
+                    .has_else = false,
+                    .branches = {},
+                    .breaks = {},
+                    .continues = {},
+                });
+                break;
+            }
+            case Token::KEYW_ELIF:
+            case Token::KEYW_ELSE:
+            {
+                if (!blocks.size() || blocks.back().type != Token::KEYW_IF)
+                {
+                    Logger::Error("Syntax Error: 'elif/else' without matching 'if' at line", {LineOf(inst)});
+                    return Error::SYNTAX;
+                }
+                Block &block = blocks.back();
+                if (block.has_else)
+                {
+                    Logger::Error("Syntax Error: 'elif/else' after 'else' at line", {LineOf(inst)});
+                    return Error::SYNTAX;
+                }
+                insts[block.last_branch].jump = i;
+                block.last_branch = i;
+                block.has_else = inst.type == Token::KEYW_ELSE;
+                block.branches.push_back(i);
+                break;
+            }
+            case Token::KEYW_ENDIF:
+            {
+                if (!blocks.size() || blocks.back().type != Token::KEYW_IF)
+                {
+                    Logger::Error("Syntax Error: 'endif' without matching 'if' at line", {LineOf(inst)});
+                    return Error::SYNTAX;
+                }
+                Block &block = blocks.back();
+                insts[block.last_branch].jump = i;
+                for (size_t b : block.branches)
+                    insts[b].exit = i;
+                blocks.pop_back();
+                break;
+            }
+            case Token::KEYW_WHILE:
+            case Token::KEYW_FOR:
+            {
+                inst.reg = CountEnclosingFor(blocks);
+                blocks.push_back(Block{
+                    .type = inst.type,
+                    .start = i,
+                    .last_branch = i,
+                    .has_else = false,
+                    .branches = {},
+                    .breaks = {},
+                    .continues = {},
+                });
+                if (inst.type == Token::KEYW_FOR && scope.loop_depth < inst.reg + 1)
+                    scope.loop_depth = inst.reg + 1;
+                break;
+            }
+            case Token::KEYW_ENDWHILE:
+            case Token::KEYW_ENDFOR:
+            {
+                Token::TYPE opening = inst.type == Token::KEYW_ENDWHILE
+                                          ? Token::KEYW_WHILE
+                                          : Token::KEYW_FOR;
+                if (!blocks.size() || blocks.back().type != opening)
+                {
+                    Logger::Error("Syntax Error: 'endwhile/endfor' without matching 'while/for' at line", {LineOf(inst)});
+                    return Error::SYNTAX;
+                }
+                Block &block = blocks.back();
+                inst.jump = block.start;
+                inst.reg = insts[block.start].reg;
+                insts[block.start].exit = i + 1;
+                for (size_t b : block.breaks)
+                    insts[b].exit = i + 1;
+                for (size_t c : block.continues)
+                    insts[c].jump = (inst.type == Token::KEYW_ENDWHILE) ? block.start : i;
+                blocks.pop_back();
+                break;
+            }
+            case Token::KEYW_BREAK:
+            case Token::KEYW_CONTINUE:
+            {
+                Block *loop = InnermostLoop(blocks);
+                if (!loop)
+                {
+                    Logger::Error("Syntax Error: 'break/continue' outside of a loop at line", {LineOf(inst)});
+                    return Error::SYNTAX;
+                }
+                if (inst.type == Token::KEYW_BREAK)
+                    loop->breaks.push_back(i);
+                else
+                    loop->continues.push_back(i);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        if (blocks.size())
+        {
+            Logger::Error("Syntax Error: block opened at line", {LineOf(insts[blocks.back().start]), "was not closed in scope", scope.name});
+            return Error::SYNTAX;
+        }
+        return Error::OK;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+#include "../types/token.hpp"
+#include "../types/instructions.hpp"
+#include "../types/scope.hpp"
+
+namespace Compiler
+{
+    namespace
+    {
+        // Instructions after which the rest of the body may not run.
+        bool MaySkip(Token::TYPE type)
+        {
+            switch (type)
+            {
+            case Token::KEYW_IF:
+            case Token::KEYW_ELIF:
+            case Token::KEYW_ELSE:
+            case Token::KEYW_WHILE:
+            case Token::KEYW_FOR:
+            case Token::KEYW_RETURN:
+                return true;
+            default:
+                return false;
+            }
+        }
+    }
+
+    // Escape analysis of a function body, sets Instruction::local_target on the set/var/fetch
+    // instructions whose string result may live in the frame arena.
+    // That needs the written name to be a local, an argument or a 'var' run before any branch,
+    // which no 'return' of the function names. Other escapes are caught at runtime, see VarPromote.
+    void MarkLocalTargets(Scope &scope)
+    {
+        if (scope.type != SCOPE_TYPE::FUNC)
+            return;
+
+        std::unordered_set<std::string> locals{};
+        for (const auto &[name, value] : scope.args)
+            locals.insert(name);
+        for (const Instruction &inst : scope.instructions)
+        {
+            if (MaySkip(inst.type))
+                break;
+            if (inst.type == Token::KEYW_VAR && inst.args.size() > 1)
+                locals.insert(inst.args[1].content);
+        }
+
+        for (const Instruction &inst : scope.instructions)
+        {
+            if (inst.type != Token::KEYW_RETURN)
+                continue;
+            for (const Token::Token &tok : inst.args)
+            {
+                if (tok.type == Token::NAME)
+                    locals.erase(tok.content);
+            }
+        }
+
+        for (Instruction &inst : scope.instructions)
+        {
+            bool writes = inst.type == Token::KEYW_SET || inst.type == Token::KEYW_VAR || inst.type == Token::KEYW_FETCH;
+            if (writes && inst.args.size() > 1 && locals.contains(inst.args[1].content))
+                inst.local_target = true;
+        }
+    }
+}
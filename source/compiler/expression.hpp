@@ -0,0 +1,288 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../logger/logger.hpp"
+
+#include "../types/error.hpp"
+#include "../types/token.hpp"
+#include "../types/expression.hpp"
+#include "../types/instructions.hpp"
+#include "../make_variant/make_variant.hpp"
+
+namespace Compiler
+{
+    // Size of the value stack used to evaluate expressions.
+    const size_t MAX_EXPR_DEPTH = 32;
+
+    struct ExprNode
+    {
+        Token::Token tok;
+        std::unique_ptr<ExprNode> lhs;
+        std::unique_ptr<ExprNode> rhs;
+    };
+
+    namespace
+    {
+        std::unique_ptr<ExprNode> ParseComparison(const std::vector<Token::Token> &toks, size_t &pos);
+
+        std::unique_ptr<ExprNode> MakeNode(const Token::Token &tok,
+                                           std::unique_ptr<ExprNode> lhs = nullptr,
+                                           std::unique_ptr<ExprNode> rhs = nullptr)
+        {
+            return std::unique_ptr<ExprNode>(new ExprNode{
+                .tok = tok,
+                .lhs = std::move(lhs),
+                .rhs = std::move(rhs),
+            });
+        }
+
+        bool IsComparisonOp(Token::TYPE type)
+        {
+            return type == Token::OP_LT || type == Token::OP_GT ||
+                   type == Token::OP_LE || type == Token::OP_GE ||
+                   type == Token::OP_EQ || type == Token::OP_NE;
+        }
+
+        bool IsAdditiveOp(Token::TYPE type)
+        {
+            return type == Token::OP_ADD || type == Token::OP_SUB;
+        }
+
+        bool IsMultiplicativeOp(Token::TYPE type)
+        {
+            return type == Token::OP_MUL || type == Token::OP_DIV || type == Token::OP_MOD;
+        }
+
+        // 'x -1' is lexed as a name followed by a negative number, read it as 'x - 1'.
+        bool IsNegativeNumber(const Token::Token &tok)
+        {
+            return tok.type == Token::NUMBER && tok.content.size() > 1 && tok.content[0] == '-';
+        }
+
+        std::unique_ptr<ExprNode> ParsePrimary(const std::vector<Token::Token> &toks, size_t &pos)
+        {
+            if (pos >= toks.size())
+            {
+                Logger::Error("Syntax Error: expression ended unexpectedly.", {});
+                return nullptr;
+            }
+
+            const Token::Token &tok = toks.at(pos);
+            switch (tok.type)
+            {
+            case Token::NUMBER:
+            case Token::STRING:
+            case Token::NAME:
+                ++pos;
+                return MakeNode(tok);
+            case Token::PAREN_OPEN:
+            {
+                ++pos;
+                std::unique_ptr<ExprNode> inner = ParseComparison(toks, pos);
+                if (!inner)
+                    return nullptr;
+                if (pos >= toks.size() || toks.at(pos).type != Token::PAREN_CLOSE)
+                {
+                    Logger::Error("Syntax Error: expected ')' in expression.", {});
+                    return nullptr;
+                }
+                ++pos;
+                return inner;
+            }
+            default:
+                Logger::Error("Syntax Error: unexpected token in expression:", {tok.content});
+                return nullptr;
+            }
+        }
+
+        std::unique_ptr<ExprNode> ParseUnary(const std::vector<Token::Token> &toks, size_t &pos)
+        {
+            if (pos < toks.size() && toks.at(pos).type == Token::OP_SUB)
+            {
+                const Token::Token &op = toks.at(pos++);
+                std::unique_ptr<ExprNode> operand = ParseUnary(toks, pos);
+                if (!operand)
+                    return nullptr;
+                return MakeNode(op, std::move(operand));
+            }
+            return ParsePrimary(toks, pos);
+        }
+
+        std::unique_ptr<ExprNode> ParseMultiplicative(const std::vector<Token::Token> &toks, size_t &pos)
+        {
+            std::unique_ptr<ExprNode> lhs = ParseUnary(toks, pos);
+            while (lhs && pos < toks.size() && IsMultiplicativeOp(toks.at(pos).type))
+            {
+                const Token::Token &op = toks.at(pos++);
+                std::unique_ptr<ExprNode> rhs = ParseUnary(toks, pos);
+                if (!rhs)
+                    return nullptr;
+                lhs = MakeNode(op, std::move(lhs), std::move(rhs));
+            }
+            return lhs;
+        }
+
+        std::unique_ptr<ExprNode> ParseAdditive(const std::vector<Token::Token> &toks, size_t &pos)
+        {
+            std::unique_ptr<ExprNode> lhs = ParseMultiplicative(toks, pos);
+            while (lhs && pos < toks.size())
+            {
+                const Token::Token &tok = toks.at(pos);
+
+                if (IsNegativeNumber(tok))
+                {
+                    Token::Token op = tok;
+                    op.content = "-";
+                    op.type = Token::OP_SUB;
+
+                    // Parse the rest of the term with the literal made positive.
+                    std::vector<Token::Token> rest(toks.begin() + pos, toks.end());
+                    rest.at(0).content = tok.content.substr(1);
+                    size_t rest_pos = 0;
+                    std::unique_ptr<ExprNode> rhs = ParseMultiplicative(rest, rest_pos);
+                    if (!rhs)
+                        return nullptr;
+                    pos += rest_pos;
+                    lhs = MakeNode(op, std::move(lhs), std::move(rhs));
+                    continue;
+                }
+
+                if (!IsAdditiveOp(tok.type))
+                    break;
+
+                ++pos;
+                std::unique_ptr<ExprNode> rhs = ParseMultiplicative(toks, pos);
+                if (!rhs)
+                    return nullptr;
+                lhs = MakeNode(tok, std::move(lhs), std::move(rhs));
+            }
+            return lhs;
+        }
+
+        std::unique_ptr<ExprNode> ParseComparison(const std::vector<Token::Token> &toks, size_t &pos)
+        {
+            std::unique_ptr<ExprNode> lhs = ParseAdditive(toks, pos);
+            while (lhs && pos < toks.size() && IsComparisonOp(toks.at(pos).type))
+            {
+                const Token::Token &op = toks.at(pos++);
+                std::unique_ptr<ExprNode> rhs = ParseAdditive(toks, pos);
+                if (!rhs)
+                    return nullptr;
+                lhs = MakeNode(op, std::move(lhs), std::move(rhs));
+            }
+            return lhs;
+        }
+
+        OPCODE OpcodeOf(Token::TYPE type, bool unary)
+        {
+            switch (type)
+            {
+            case Token::OP_ADD:
+                return OPCODE::ADD;
+            case Token::OP_SUB:
+                return unary ? OPCODE::NEG : OPCODE::SUB;
+            case Token::OP_MUL:
+                return OPCODE::MUL;
+            case Token::OP_DIV:
+                return OPCODE::DIV;
+            case Token::OP_MOD:
+                return OPCODE::MOD;
+            case Token::OP_LT:
+                return OPCODE::LT;
+            case Token::OP_GT:
+                return OPCODE::GT;
+            case Token::OP_LE:
+                return OPCODE::LE;
+            case Token::OP_GE:
+                return OPCODE::GE;
+            case Token::OP_EQ:
+                return OPCODE::EQ;
+            default:
+                return OPCODE::NE;
+            }
+        }
+
+        // Emits the tree in postfix order, 'depth' is the stack height before this node.
+        Error EmitNode(const ExprNode &node, size_t depth, std::vector<ExprOp> &out)
+        {
+            if (depth + 1 > MAX_EXPR_DEPTH)
+            {
+                Logger::Error("Syntax Error: expression is too deeply nested.", {});
+                return Error::SYNTAX;
+            }
+
+            if (!node.lhs)
+            {
+                ExprOp op{
+                    .code = OPCODE::PUSH_CONST,
+                    .value = {},
+                    .name = {},
+                };
+                if (node.tok.type == Token::NAME)
+                {
+                    op.code = OPCODE::PUSH_NAME;
+                    op.name = node.tok;
+                }
+                else
+                {
+                    Token::Token literal = node.tok;
+                    Error make_err = MakeVariant(op.value, literal);
+                    if (make_err)
+                    {
+                        Logger::Error("Syntax Error: invalid value in expression:", {node.tok.content});
+                        return Error::SYNTAX;
+                    }
+                }
+                out.push_back(op);
+                return Error::OK;
+            }
+
+            Error lhs_err = EmitNode(*node.lhs, depth, out);
+            if (lhs_err)
+                return lhs_err;
+
+            if (node.rhs)
+            {
+                Error rhs_err = EmitNode(*node.rhs, depth + 1, out);
+                if (rhs_err)
+                    return rhs_err;
+            }
+
+            out.push_back(ExprOp{
+                .code = OpcodeOf(node.tok.type, !node.rhs),
+                .value = {},
+                .name = {},
+            });
+            return Error::OK;
+        }
+    }
+
+    bool IsExpressionToken(Token::TYPE type)
+    {
+        return (type >= Token::OP_ADD && type <= Token::OP_NE) ||
+               type == Token::PAREN_OPEN || type == Token::PAREN_CLOSE;
+    }
+
+    // Parses inst.args[first..] into an expression tree and compiles it into inst.expr.
+    Error CompileExpression(Instruction &inst, size_t first)
+    {
+        std::vector<Token::Token> toks(inst.args.begin() + first, inst.args.end());
+        size_t pos = 0;
+
+        std::unique_ptr<ExprNode> root = ParseComparison(toks, pos);
+        if (!root)
+            return Error::SYNTAX;
+
+        if (pos != toks.size())
+        {
+            Logger::Error("Syntax Error: unexpected token in expression:", {toks.at(pos).content});
+            return Error::SYNTAX;
+        }
+
+        inst.expr.clear();
+        return EmitNode(*root, 0, inst.expr);
+    }
+}
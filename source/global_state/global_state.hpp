@@ -1,9 +1,18 @@
 #pragma once
 
 #include <iostream>
+#include <cstdint>
 #include <unordered_map>
 
 namespace Global
 {
     std::unordered_map<std::string, std::string> args = {};
+
+    // Bumped whenever scopes or variables are added at runtime, invalidates every NameCache.
+    uint64_t scope_tree_version = 1;
+
+    void InvalidateNameCaches()
+    {
+        ++scope_tree_version;
+    }
 }
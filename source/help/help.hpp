@@ -7,11 +7,22 @@ namespace HelpRoute
     void DisplayHelp()
     {
         const std::string HELP_MSG = "\n"
-                                     "Usage: gvs <PATH> | <ARG>\n"
+                                     "Usage: gvs <PATH> [ARGS] | <ARG>\n"
                                      "\n"
                                      "Args:\n"
                                      "\t-h : Shows the list of available arguments.\n"
-                                     "\t-v : Show the version of the program.\n\n";
+                                     "\t-v : Show the version of the program.\n"
+                                     "\t--quicken-stats : Print how many expression sites were quickened or deoptimized.\n"
+                                     "\t--jit : Compile hot functions to machine code (x86-64 Linux only).\n"
+                                     "\t--jit-threshold <N> : Calls before a function gets compiled (default 100).\n"
+                                     "\t--jit-diff : Run the script interpreted then compiled and compare the outputs.\n"
+                                     "\t--log-level <debug|info|warning|error|none> : Lowest level of messages printed (default info).\n"
+                                     "\t--stats[=json] : Print call, instruction and builtin statistics to stderr at exit.\n"
+                                     "\t--profile <FILE> : Sample the call stack and write folded stacks for flamegraphs to FILE (POSIX only).\n"
+                                     "\t--profile-hz <N> : Samples per second of CPU time taken by --profile (default 1000).\n"
+                                     "\t--mem-report : Print string/array store usage and the largest allocation sites to stderr at exit.\n"
+                                     "\t--gc-stats : Print garbage collections, freed entries and pause times to stderr at exit.\n"
+                                     "\t--line-buffered : Write the output of Print at every line, the default when stdout is a terminal.\n\n";
         std::cout << HELP_MSG;
     }
 }
\ No newline at end of file
@@ -12,15 +12,16 @@
 namespace Instructions
 {
 
-    Error Set(Variant &var, Token::Token &value, bool create_as_const)
+    // Whether a variable is const is kept by its scope, see Scope::consts.
+    Error Set(Variant &var, Token::Token &value, bool var_is_const)
     {
-        if (var.flags.is_const)
+        if (var_is_const)
         {
             Logger::Error("Tried setting value of constant variable with", {value.content});
             return Error::REJECTED;
         }
 
-        Error var_err = MakeVariant(var, {value}, create_as_const);
+        Error var_err = MakeVariant(var, value);
         if (var_err)
         {
             Logger::Error("Syntax Error: expected value as second argument of 'set', got:", {value.content});
@@ -5,15 +5,25 @@
 
 #include "../logger/logger.hpp"
 #include "../helper/helper.hpp"
+#include "../global_state/global_state.hpp"
 
 #include "../types/error.hpp"
 #include "../types/token.hpp"
 #include "../types/variant.hpp"
 #include "../types/instructions.hpp"
 #include "../types/scope.hpp"
+#include "../types/loop_counter.hpp"
 #include "../instructions/instructions.hpp"
 #include "../builtin/builtin_funcs.hpp"
 #include "../make_variant/make_variant.hpp"
+#include "../registers/registers.hpp"
+#include "../operators/operators.hpp"
+#include "../operators/quickening.hpp"
+#include "../compiler/expression.hpp"
+#include "../jit/jit.hpp"
+#include "../stats/stats.hpp"
+#include "../trace/trace.hpp"
+#include "../memory/gc.hpp"
 
 namespace Interpreter
 {
@@ -28,24 +38,24 @@ namespace Interpreter
             prefix += "  ";
         }
 
-        Logger::Debug(prefix + "Scope:", {scope.name});
+        LOG_DEBUG(prefix + "Scope:", {scope.name});
 
-        Logger::Debug(prefix + "Args:", {});
+        LOG_DEBUG(prefix + "Args:", {});
         for (auto &[key, val] : scope.args)
         {
-            Logger::Debug(prefix + key, {});
+            LOG_DEBUG(prefix + key, {});
         }
 
-        Logger::Debug(prefix + "Vars:", {});
+        LOG_DEBUG(prefix + "Vars:", {});
         for (auto &[key, val] : scope.vars)
         {
-            Logger::Debug(prefix + key, {});
+            LOG_DEBUG(prefix + key, {});
         }
 
-        Logger::Debug(prefix + "Scopes:", {});
+        LOG_DEBUG(prefix + "Scopes:", {});
         for (auto &[key, val] : scope.scopes)
         {
-            Logger::Debug(prefix + key, {});
+            LOG_DEBUG(prefix + key, {});
             PrintTreeComposition(val, depth + 1);
         }
     }
@@ -55,223 +65,394 @@ namespace Interpreter
         return (type == VALUE_TYPE::INT || type == VALUE_TYPE::NIL || type == VALUE_TYPE::FLOAT);
     }
 
-    Variant ResolveName(Token::Token varname, Scope &parent_scope)
+    bool IsCacheValid(const NameCache &cache, const Scope &context)
     {
-        if (!Helper::StringContains(varname.content, '.'))
+        return cache.version == Global::scope_tree_version && cache.context == &context;
+    }
+
+    void FillCache(NameCache &cache, Scope &context, Scope *scope, Variant *slot)
+    {
+        cache = NameCache{
+            .version = Global::scope_tree_version,
+            .context = &context,
+            .scope = scope,
+            .slot = slot,
+        };
+    }
+
+    Variant *FindNameSlot(const std::string &name, Scope &parent_scope)
+    {
+        if (!Helper::StringContains(name, '.'))
         {
-            if (Helper::UnorderedMapHasKey(parent_scope.vars, varname.content))
+            if (Helper::UnorderedMapHasKey(parent_scope.vars, name))
             {
-                return parent_scope.vars.at(varname.content);
+                return &parent_scope.vars.at(name);
             }
             else if (parent_scope.type == SCOPE_TYPE::FUNC &&
-                     Helper::PairVectorHasKey(parent_scope.args, varname.content))
+                     Helper::PairVectorHasKey(parent_scope.args, name))
             {
                 Variant *v = nullptr;
-                Helper::PairVectorGet(parent_scope.args, varname.content, &v);
-                return *v;
+                Helper::PairVectorGet(parent_scope.args, name, &v);
+                return v;
             }
 
             // Recursive scope walking
             Scope *next_parent_scope = parent_scope.parent;
             while (next_parent_scope)
             {
-                if (Helper::UnorderedMapHasKey(next_parent_scope->vars, varname.content))
+                if (Helper::UnorderedMapHasKey(next_parent_scope->vars, name))
                 {
-                    return next_parent_scope->vars.at(varname.content);
+                    return &next_parent_scope->vars.at(name);
                 }
                 next_parent_scope = next_parent_scope->parent;
             }
 
-            Variant v = {
-                .type = VALUE_TYPE::NIL,
-                .d64 = 0,
-            };
-            return v;
+            if (name == Registers::RET_VAL_NAME)
+            {
+                return &Registers::ret_val;
+            }
+            return nullptr;
+        }
+
+        std::vector<std::string> scopes = Helper::SplitString(name, '.');
+
+        Scope *scope = nullptr;
+        if (Helper::UnorderedMapHasKey(parent_scope.scopes, scopes.at(0)))
+        {
+            scope = &parent_scope;
         }
         else
         {
-            std::vector<std::string> scopes = Helper::SplitString(varname.content, '.');
-
-            Scope *scope = nullptr;
-            if (Helper::UnorderedMapHasKey(parent_scope.scopes, scopes.at(0)))
-            {
-                scope = &parent_scope;
-            }
-            /*
-            else if (Helper::UnorderedMapHasKey(global_scope.scopes, scopes.at(0)))
-            {
-                scope = &global_scope;
-            }*/
-            else
+            // Recursive scope walking
+            Scope *next_parent_scope = parent_scope.parent;
+            while (next_parent_scope)
             {
-                // Recursive scope walking
-                Scope *next_parent_scope = parent_scope.parent;
-                while (next_parent_scope)
-                {
-                    if (Helper::UnorderedMapHasKey(next_parent_scope->scopes, scopes.at(0)))
-                    {
-                        scope = next_parent_scope;
-                        break;
-                    }
-                    next_parent_scope = next_parent_scope->parent;
-                }
-
-                if (!scope)
+                if (Helper::UnorderedMapHasKey(next_parent_scope->scopes, scopes.at(0)))
                 {
-                    Logger::Error("Syntax Error: could not find scope", {scopes.at(0)});
-                    Variant v = {
-                        .type = VALUE_TYPE::NIL,
-                        .d64 = 0,
-                    };
-                    return v;
+                    scope = next_parent_scope;
+                    break;
                 }
+                next_parent_scope = next_parent_scope->parent;
             }
 
-            for (std::string &scope_name : scopes)
+            if (!scope)
             {
-                if (Helper::UnorderedMapHasKey(scope->scopes, scope_name))
-                {
-                    scope = &scope->scopes.at(scope_name);
-                    continue;
-                }
-                else if (Helper::UnorderedMapHasKey(scope->vars, scope_name))
-                {
-                    return scope->vars.at(scope_name);
-                }
-                else if (Helper::PairVectorHasKey(scope->args, scope_name))
-                {
-                    Variant *v = nullptr;
-                    Helper::PairVectorGet(scope->args, scope_name, &v);
-                    return *v;
-                }
+                Logger::Error("Syntax Error: could not find scope", {scopes.at(0)});
+                return nullptr;
+            }
+        }
 
-                Variant v = {
-                    .type = VALUE_TYPE::NIL,
-                    .d64 = 0,
-                };
+        for (std::string &scope_name : scopes)
+        {
+            if (Helper::UnorderedMapHasKey(scope->scopes, scope_name))
+            {
+                scope = &scope->scopes.at(scope_name);
+                continue;
+            }
+            else if (Helper::UnorderedMapHasKey(scope->vars, scope_name))
+            {
+                return &scope->vars.at(scope_name);
+            }
+            else if (Helper::PairVectorHasKey(scope->args, scope_name))
+            {
+                Variant *v = nullptr;
+                Helper::PairVectorGet(scope->args, scope_name, &v);
                 return v;
             }
+            return nullptr;
         }
+        return nullptr;
+    }
 
-        Variant v = {
-            .type = VALUE_TYPE::NIL,
-            .d64 = 0,
-        };
-        return v;
+    void FillFieldCache(NameCache &cache, Scope &context, Variant *instance, uint32_t shape, uint32_t field)
+    {
+        FillCache(cache, context, nullptr, instance);
+        cache.shape = shape;
+        cache.field = field;
+    }
+
+    // Finds 'name' as 'instance.field' with the instance held by a variable.
+    bool FindFieldSlot(const std::string &name, Scope &parent_scope, Variant *&instance, uint32_t &field)
+    {
+        size_t dot = name.rfind('.');
+        if (dot == std::string::npos)
+            return false;
+
+        Variant *slot = FindNameSlot(name.substr(0, dot), parent_scope);
+        if (!slot || VarType(*slot) != VALUE_TYPE::STRUCT)
+            return false;
+
+        uint32_t index = Shapes::FieldIndex(VarGetStruct(*slot).shape, name.substr(dot + 1));
+        if (index == Shapes::NO_FIELD)
+            return false;
+
+        instance = slot;
+        field = index;
+        return true;
+    }
+
+    // Writes field 'field' of the instance in 'instance' if it still has 'shape', copying a shared instance first.
+    bool SetField(Variant &instance, uint32_t shape, uint32_t field, const Variant &value)
+    {
+        if (VarType(instance) != VALUE_TYPE::STRUCT || VarGetStruct(instance).shape != shape)
+            return false;
+
+        // Promoted before the instance is fetched, promoting may allocate.
+        Variant stored = VarPromoted(value);
+        VarMutableStruct(instance).fields[field] = stored;
+        return true;
+    }
+
+    // A variable declared with 'const' is never written, checked before the set cache is filled so cached writes skip it.
+    bool RejectConstSet(const Scope &scope, const std::string &name, const Token::Token &value)
+    {
+        if (!scope.consts.contains(name))
+            return false;
+        Logger::Error("Tried setting value of constant variable with", {value.content});
+        return true;
+    }
+
+    Variant ResolveName(Token::Token &varname, Scope &parent_scope)
+    {
+        if (IsCacheValid(varname.cache, parent_scope))
+        {
+            if (varname.cache.field == Shapes::NO_FIELD)
+                return *varname.cache.slot;
+
+            const Variant &instance = *varname.cache.slot;
+            if (VarType(instance) == VALUE_TYPE::STRUCT && VarGetStruct(instance).shape == varname.cache.shape)
+                return VarGetStruct(instance).fields[varname.cache.field];
+        }
+
+        Variant *instance = nullptr;
+        uint32_t field = 0;
+        if (Helper::StringContains(varname.content, '.') && FindFieldSlot(varname.content, parent_scope, instance, field))
+        {
+            const StructInstance &object = VarGetStruct(*instance);
+            FillFieldCache(varname.cache, parent_scope, instance, object.shape, field);
+            return object.fields[field];
+        }
+
+        Variant *slot = FindNameSlot(varname.content, parent_scope);
+        if (!slot)
+        {
+            return NIL_VALUE;
+        }
+
+        FillCache(varname.cache, parent_scope, nullptr, slot);
+        return *slot;
+    }
+
+    // Value of the argument at inst.args[tok_i], 'arg_i' counting only arguments.
+    Variant CallArgument(Instruction &inst, size_t tok_i, size_t arg_i, Scope &parent_scope)
+    {
+        Token::Token &arg = inst.args[tok_i];
+        if (arg.type == Token::NAME)
+            return ResolveName(arg, parent_scope);
+        return inst.call_args[arg_i];
     }
 
-    Error SetArgumentsBeforeCall(Scope &scope, std::vector<Token::Token> &args, Scope &parent_scope)
+    Error SetArgumentsBeforeCall(Scope &scope, Instruction &inst, size_t first_arg, Scope &parent_scope)
     {
-        if (args.size() > scope.args.size())
+        size_t args_count = inst.call_args.size();
+
+        if (args_count > scope.args.size())
         {
             Logger::Error("Syntax Error: too many arguments for call to function", {scope.name});
             return Error::SYNTAX;
         }
 
-        if (args.size() < scope.args.size())
+        if (args_count < scope.args.size())
         {
             Logger::Error("Syntax Error: not enough arguments for call to function", {scope.name});
             return Error::SYNTAX;
         }
 
         size_t i = 0;
-        for (auto &[key, val] : scope.args)
+        for (size_t tok_i = first_arg; tok_i < inst.args.size(); ++tok_i)
         {
-            if (args[i].type == Token::NAME)
-            {
-                Variant v = ResolveName(args[i], parent_scope);
-                scope.args[i].second = v;
-            }
-            else
-            {
-                Variant *v = nullptr;
-                Helper::PairVectorGet(scope.args, key, &v);
-                Error set_err = Instructions::Set(*v, args[i], false);
-                if (set_err)
-                    return set_err;
-            }
+            if (inst.args[tok_i].type == Token::COMMA)
+                continue;
+
+            Variant &slot = scope.args[i].second;
+            slot = CallArgument(inst, tok_i, i, parent_scope);
+            VarPromote(slot);
+            if (inst.args[tok_i].type == Token::NAME)
+                Memory::ShareArray(slot);
             ++i;
         }
         return Error::OK;
     }
 
-    Error FunctionCall(Instruction inst, Scope &parent_scope, Scope &global_scope)
+    // Runs the body of a struct once, its variables become the fields and their values the defaults.
+    Error BuildShape(Scope &type, Scope &global_scope)
     {
-        if (inst.args.size() < 1)
+        Error exec_err = ExecuteScope(type, global_scope);
+        if (exec_err)
+            return exec_err;
+
+        Shape shape{.scope = &type};
+        for (const Instruction &inst : type.instructions)
         {
-            Logger::Error("Syntax Error: not enough arguments for instruction call.", {});
+            if (inst.type != Token::KEYW_VAR && inst.type != Token::KEYW_CONST && inst.type != Token::KEYW_ARRAY)
+                continue;
+
+            const std::string &name = inst.args.at(1).content;
+            if (!Helper::UnorderedMapHasKey(type.vars, name) || Helper::UnorderedMapHasKey(shape.index, name))
+                continue;
+
+            // Every instance starts out with the same handles, so they count as shared.
+            Variant &value = type.vars.at(name);
+            Memory::ShareArray(value);
+            shape.index[name] = static_cast<uint32_t>(shape.fields.size());
+            shape.fields.push_back(name);
+            shape.defaults.push_back(VarPromoted(value));
+        }
+
+        type.shape = static_cast<uint32_t>(Shapes::shapes.size());
+        Shapes::shapes.push_back(std::move(shape));
+        return Error::OK;
+    }
+
+    // Calling a struct makes an instance, the arguments set its first fields in order.
+    Error Construct(Scope &type, Instruction &inst, size_t first_arg, Scope &parent_scope, Scope &global_scope)
+    {
+        if (type.shape == NO_SHAPE)
+        {
+            Error shape_err = BuildShape(type, global_scope);
+            if (shape_err)
+                return shape_err;
+        }
+
+        const Shape &shape = Shapes::shapes[type.shape];
+        if (inst.call_args.size() > shape.fields.size())
+        {
+            Logger::Error("Syntax Error: too many arguments for struct", {type.name});
             return Error::SYNTAX;
         }
 
-        Token::Token &funcname = inst.args.at(1);
+        StructInstance instance{.shape = type.shape, .fields = shape.defaults};
+        size_t i = 0;
+        for (size_t tok_i = first_arg; tok_i < inst.args.size(); ++tok_i)
+        {
+            if (inst.args[tok_i].type == Token::COMMA)
+                continue;
+
+            Variant value = CallArgument(inst, tok_i, i, parent_scope);
+            if (inst.args[tok_i].type == Token::NAME)
+                Memory::ShareArray(value);
+            instance.fields[i] = VarPromoted(value);
+            ++i;
+        }
+
+        Registers::ret_val = VarMakeHandle(VALUE_TYPE::STRUCT, Memory::AllocStruct(std::move(instance)));
+        return Error::OK;
+    }
+
+    Error CallScope(Scope &func, Instruction &inst, size_t first_arg, Scope &parent_scope, Scope &global_scope)
+    {
+        if (func.type == SCOPE_TYPE::CLASS)
+        {
+            Error construct_err = Construct(func, inst, first_arg, parent_scope, global_scope);
+            Registers::ret_unshared = false;
+            return construct_err;
+        }
+
+        Error arg_err = SetArgumentsBeforeCall(func, inst, first_arg, parent_scope);
+        if (arg_err)
+            return arg_err;
+        Error exec_err = ExecuteScope(func, global_scope);
+        // Left over from a builtin called inside, the returned value may be held by a variable.
+        Registers::ret_unshared = false;
+        if (exec_err)
+            return exec_err;
+        return Error::OK;
+    }
+
+    // Calls a builtin with the values of inst.args[first_arg..], its result goes to the return register.
+    // The arguments are pushed on the argument stack and handed to the builtin as a span.
+    Error CallBuiltin(BuiltinFuncs::BuiltinFunc func, Instruction &inst, size_t first_arg, Scope &parent_scope)
+    {
+        size_t args_count = inst.call_args.size();
+        if (Registers::arg_top + args_count > Registers::ARG_STACK_SIZE)
+        {
+            Logger::Error("Runtime Error: argument stack overflow in call to function", {inst.args.at(first_arg - 2).content});
+            return Error::REJECTED;
+        }
+
+        Variant *args = &Registers::arg_stack[Registers::arg_top];
+        size_t i = 0;
+        for (size_t tok_i = first_arg; tok_i < inst.args.size(); ++tok_i)
+        {
+            if (inst.args[tok_i].type == Token::COMMA)
+                continue;
+            args[i] = CallArgument(inst, tok_i, i, parent_scope);
+            ++i;
+        }
+
+        if (Stats::enabled)
+            Stats::CountBuiltin(func);
 
-        std::vector<Token::Token> args = {};
-        for (size_t i = 3; i < inst.args.size(); ++i)
+        Registers::first_arg_owned = inst.owns_first_arg;
+        Registers::ret_unshared = false;
+        Registers::arg_top += args_count;
+        bool builtin_error = false;
+        Variant return_val = func(args, args_count, builtin_error);
+        Registers::arg_top -= args_count;
+
+        if (builtin_error)
+            return Error::UNHANDLED;
+        Registers::ret_val = return_val;
+        return Error::OK;
+    }
+
+    // Calls the function named by inst.args[offset + 1], with its arguments starting at inst.args[offset + 3].
+    Error FunctionCall(Instruction &inst, size_t offset, Scope &parent_scope, Scope &global_scope)
+    {
+        if (inst.args.size() < offset + 2)
         {
-            if (inst.args[i].type != Token::COMMA)
-                args.push_back(inst.args[i]);
+            Logger::Error("Syntax Error: not enough arguments for instruction call.", {});
+            return Error::SYNTAX;
         }
 
-        Logger::Debug("CALL", {funcname.content});
+        Token::Token &funcname = inst.args.at(offset + 1);
+        size_t first_arg = offset + 3;
+
+        LOG_DEBUG("CALL", {funcname.content});
+
+        if (IsCacheValid(funcname.cache, global_scope))
+        {
+            if (funcname.cache.builtin)
+                return CallBuiltin(funcname.cache.builtin, inst, first_arg, parent_scope);
+            return CallScope(*funcname.cache.scope, inst, first_arg, parent_scope, global_scope);
+        }
 
         if (!Helper::StringContains(funcname.content, '.'))
         {
             if (Helper::UnorderedMapHasKey(parent_scope.scopes, funcname.content))
             {
                 Scope &func = parent_scope.scopes.at(funcname.content);
-                Error arg_err = SetArgumentsBeforeCall(func, args, parent_scope);
-                if (arg_err)
-                    return arg_err;
-                Error exec_err = ExecuteScope(func, global_scope);
-                if (exec_err)
-                    return exec_err;
-                return Error::OK;
+                FillCache(funcname.cache, global_scope, &func, nullptr);
+                return CallScope(func, inst, first_arg, parent_scope, global_scope);
             }
             else if (Helper::UnorderedMapHasKey(global_scope.scopes, funcname.content))
             {
                 Scope &func = global_scope.scopes.at(funcname.content);
 
-                if (func.type != SCOPE_TYPE::FUNC)
+                if (func.type != SCOPE_TYPE::FUNC && func.type != SCOPE_TYPE::CLASS)
                 {
                     Logger::Error("Syntax Error: cannot use 'call' for a scope that isn't a function.", {});
                     return Error::SYNTAX;
                 }
 
-                Error arg_err = SetArgumentsBeforeCall(func, args, parent_scope);
-                if (arg_err)
-                    return arg_err;
-                Error exec_err = ExecuteScope(func, global_scope);
-                if (exec_err)
-                    return exec_err;
-                return Error::OK;
+                FillCache(funcname.cache, global_scope, &func, nullptr);
+                return CallScope(func, inst, first_arg, parent_scope, global_scope);
             }
-            else if (BuiltinFuncs::IsBuiltIn(funcname.content))
+            else if (BuiltinFuncs::BuiltinFunc builtin = BuiltinFuncs::FindBuiltIn(funcname.content))
             {
-                std::vector<Variant> varargs = {};
-                for (Token::Token &tok : args)
-                {
-                    Variant v;
-                    if (tok.type == Token::NAME)
-                    {
-                        v = ResolveName(tok, parent_scope);
-                    }
-                    else
-                    {
-                        Error var_err = MakeVariant(v, {tok});
-                        if (var_err)
-                        {
-                            Logger::Error("Syntax Error: failed to make value from argument to function call", {funcname.content});
-                            return var_err;
-                        }
-                    }
-                    varargs.push_back(v);
-                }
-                bool builtin_error = false;
-                Variant return_val = BuiltinFuncs::CallBuiltIn(funcname.content, varargs, builtin_error);
-                if (builtin_error)
-                    return Error::UNHANDLED;
-                global_scope.vars.insert_or_assign("retVal", return_val);
-                return Error::OK;
+                FillCache(funcname.cache, global_scope, nullptr, nullptr);
+                funcname.cache.builtin = builtin;
+                return CallBuiltin(builtin, inst, first_arg, parent_scope);
             }
             Logger::Error("Syntax Error: could not find function", {funcname.content});
             return Error::SYNTAX;
@@ -297,25 +478,21 @@ namespace Interpreter
 
             for (std::string &scope_name : scopes)
             {
-                Logger::Debug("Searching in scope:", {scope_name});
+                LOG_DEBUG("Searching in scope:", {scope_name});
 
                 if (Helper::UnorderedMapHasKey(scope->scopes, scope_name))
                 {
                     scope = &scope->scopes.at(scope_name);
-                    Logger::Debug("SCOPENAME:", {scope->name});
-                    if (!(scope->type == SCOPE_TYPE::FUNC && scope->name == scopes.back()))
+                    LOG_DEBUG("SCOPENAME:", {scope->name});
+                    bool callable = scope->type == SCOPE_TYPE::FUNC || scope->type == SCOPE_TYPE::CLASS;
+                    if (!(callable && scope->name == scopes.back()))
                     {
                         continue;
                     }
                 }
 
-                Error arg_err = SetArgumentsBeforeCall(*scope, args, parent_scope);
-                if (arg_err)
-                    return arg_err;
-                Error exec_err = ExecuteScope(*scope, global_scope);
-                if (exec_err)
-                    return exec_err;
-                return Error::OK;
+                FillCache(funcname.cache, global_scope, scope, nullptr);
+                return CallScope(*scope, inst, first_arg, parent_scope, global_scope);
             }
 
             Logger::Error("Syntax Error: failed to find function:", {funcname.content});
@@ -323,24 +500,77 @@ namespace Interpreter
         }
     }
 
-    Error ExecuteInstruction(Instruction &inst, Scope &parent_scope, Scope &global_scope)
+    Error EvaluateExpression(Instruction &inst, Scope &parent_scope, Variant &out)
     {
-        Logger::Debug("INST", {inst.args.at(0).content});
-        switch (inst.type)
+        // A lone name copies the variable, so an array handle in it becomes shared.
+        if (inst.expr.size() == 1 && inst.expr[0].code == OPCODE::PUSH_NAME)
         {
-        case Token::KEYW_FETCH:
+            out = ResolveName(inst.expr[0].name, parent_scope);
+            Memory::ShareArray(out);
+            return Error::OK;
+        }
+
+        Variant stack[Compiler::MAX_EXPR_DEPTH];
+        size_t top = 0;
+
+        for (ExprOp &op : inst.expr)
         {
-            std::vector<Token::Token> args{};
-            for (size_t i = 2; i < inst.args.size(); ++i)
+            switch (op.code)
+            {
+            case OPCODE::PUSH_CONST:
+                stack[top++] = op.value;
+                break;
+            case OPCODE::PUSH_NAME:
+                stack[top++] = ResolveName(op.name, parent_scope);
+                break;
+            case OPCODE::NEG:
             {
-                args.push_back(inst.args[i]);
+                Error neg_err = Operators::Negate(stack[top - 1], stack[top - 1]);
+                if (neg_err)
+                    return neg_err;
+                break;
             }
+            default:
+            {
+                Error op_err = Quickening::Binary(op, stack[top - 2], stack[top - 1], stack[top - 2]);
+                if (op_err)
+                    return op_err;
+                --top;
+                break;
+            }
+            }
+        }
+
+        out = stack[0];
+        return Error::OK;
+    }
+
+    // Lets the results of a set/var/fetch of a non-escaping local go to the frame arena while it runs.
+    struct ArenaWindow
+    {
+        size_t saved;
+
+        explicit ArenaWindow(const Instruction &inst) : saved(Memory::arena_frame)
+        {
+            if (inst.local_target)
+                Memory::arena_frame = Registers::frame_depth.load(std::memory_order_relaxed);
+        }
+
+        ~ArenaWindow()
+        {
+            Memory::arena_frame = saved;
+        }
+    };
 
-            Instruction temp_inst = {
-                .type = Token::KEYW_CALL,
-                .args = args,
-            };
-            Error call_err = FunctionCall(temp_inst, parent_scope, global_scope);
+    Error ExecuteInstruction(Instruction &inst, Scope &parent_scope, Scope &global_scope)
+    {
+        LOG_DEBUG("INST", {inst.args.at(0).content});
+        switch (inst.type)
+        {
+        case Token::KEYW_FETCH:
+        {
+            ArenaWindow window(inst);
+            Error call_err = FunctionCall(inst, 2, parent_scope, global_scope);
             if (call_err)
                 return call_err;
         }
@@ -363,26 +593,58 @@ namespace Interpreter
 
             Variant var_val{};
 
+            if (varname.content == Registers::RET_VAL_NAME)
+            {
+                Logger::Error("Syntax Error: cannot assign to read-only name", {varname.content});
+                return Error::SYNTAX;
+            }
+
             if (inst.type == Token::KEYW_FETCH)
             {
-                var_val = global_scope.vars.at("retVal");
+                var_val = Registers::ret_val;
+                // The result may be held by another variable too, unless a builtin wrote it for this one.
+                if (!Registers::ret_unshared)
+                    Memory::ShareArray(var_val);
+            }
+            else if (inst.expr.size())
+            {
+                ArenaWindow window(inst);
+                Error eval_err = EvaluateExpression(inst, parent_scope, var_val);
+                if (eval_err)
+                    return eval_err;
             }
             else if (value.type == Token::NAME)
             {
                 var_val = ResolveName(value, parent_scope);
+                Memory::ShareArray(var_val);
             }
             else
             {
-                Error make_err = MakeVariant(var_val, value, is_const);
+                Error make_err = MakeVariant(var_val, value);
                 if (make_err)
                     return make_err;
             }
 
-            Logger::Debug("SET", {varname.content, value.content});
+            // A string of the frame arena only stays there when it goes to a local of the same frame.
+            if (!inst.local_target)
+                VarPromote(var_val);
+
+            LOG_DEBUG("SET", {varname.content, value.content});
+
+            if (!no_override && IsCacheValid(varname.cache, parent_scope))
+            {
+                if (varname.cache.field == Shapes::NO_FIELD)
+                {
+                    *varname.cache.slot = var_val;
+                    return Error::OK;
+                }
+                if (SetField(*varname.cache.slot, varname.cache.shape, varname.cache.field, var_val))
+                    return Error::OK;
+            }
 
             if (!Helper::StringContains(varname.content, '.'))
             {
-                Logger::Debug("setting:", {varname.content, "in scope:", parent_scope.name});
+                LOG_DEBUG("setting:", {varname.content, "in scope:", parent_scope.name});
 
                 if (Helper::UnorderedMapHasKey(parent_scope.vars, varname.content))
                 {
@@ -391,7 +653,11 @@ namespace Interpreter
                         Logger::Error("Syntax Error: variable", {varname.content, "already exists in scope", parent_scope.name});
                         return Error::SYNTAX;
                     }
-                    parent_scope.vars.insert_or_assign(varname.content, var_val);
+                    if (RejectConstSet(parent_scope, varname.content, value))
+                        return Error::REJECTED;
+                    Variant &slot = parent_scope.vars.at(varname.content);
+                    slot = var_val;
+                    FillCache(varname.cache, parent_scope, nullptr, &slot);
                     return Error::OK;
                 }
                 else if (parent_scope.type == SCOPE_TYPE::FUNC &&
@@ -405,6 +671,7 @@ namespace Interpreter
                     Variant *v = nullptr;
                     Helper::PairVectorGet(parent_scope.args, varname.content, &v);
                     *v = var_val;
+                    FillCache(varname.cache, parent_scope, nullptr, v);
                     return Error::OK;
                 }
 
@@ -419,7 +686,11 @@ namespace Interpreter
                             Logger::Error("Syntax Error: variable", {varname.content, "already exists in scope", next_parent_scope->name});
                             return Error::SYNTAX;
                         }
-                        next_parent_scope->vars.insert_or_assign(varname.content, var_val);
+                        if (RejectConstSet(*next_parent_scope, varname.content, value))
+                            return Error::REJECTED;
+                        Variant &slot = next_parent_scope->vars.at(varname.content);
+                        slot = var_val;
+                        FillCache(varname.cache, parent_scope, nullptr, &slot);
                         return Error::OK;
                     }
                     next_parent_scope = next_parent_scope->parent;
@@ -432,15 +703,33 @@ namespace Interpreter
                 }
 
                 parent_scope.vars.insert({varname.content, var_val});
+                if (is_const)
+                    parent_scope.consts.insert(varname.content);
+                Global::InvalidateNameCaches();
                 return Error::OK;
             }
             else
             {
+                Variant *instance = nullptr;
+                uint32_t field = 0;
+                if (FindFieldSlot(varname.content, parent_scope, instance, field))
+                {
+                    if (no_override)
+                    {
+                        Logger::Error("Syntax Error: cannot declare struct field", {varname.content});
+                        return Error::SYNTAX;
+                    }
+                    uint32_t shape = VarGetStruct(*instance).shape;
+                    SetField(*instance, shape, field, var_val);
+                    FillFieldCache(varname.cache, parent_scope, instance, shape, field);
+                    return Error::OK;
+                }
+
                 std::vector<std::string> scopes = Helper::SplitString(varname.content, '.');
 
                 for (std::string &s : scopes)
                 {
-                    Logger::Debug("COMPOSITE:", {s});
+                    LOG_DEBUG("COMPOSITE:", {s});
                 }
 
                 Scope *scope = nullptr;
@@ -483,7 +772,11 @@ namespace Interpreter
                             Logger::Error("Syntax Error: variable", {varname.content, "already exists in scope", scope->name});
                             return Error::SYNTAX;
                         }
-                        scope->vars.insert_or_assign(scope_name, var_val);
+                        if (RejectConstSet(*scope, scope_name, value))
+                            return Error::REJECTED;
+                        Variant &slot = scope->vars.at(scope_name);
+                        slot = var_val;
+                        FillCache(varname.cache, parent_scope, nullptr, &slot);
                         return Error::OK;
                     }
                     else if (scope->type == SCOPE_TYPE::FUNC && Helper::PairVectorHasKey(scope->args, scope_name))
@@ -496,14 +789,14 @@ namespace Interpreter
                         Variant *v = nullptr;
                         Helper::PairVectorGet(scope->args, scope_name, &v);
                         *v = var_val;
+                        FillCache(varname.cache, parent_scope, nullptr, v);
                         return Error::OK;
                     }
 
-                    Logger::Debug("Failed to find name:", {scope_name, "in scope:", scope->name});
+                    LOG_DEBUG("Failed to find name:", {scope_name, "in scope:", scope->name});
 
-#if !GVS_RELEASE
-                    PrintTreeComposition(global_scope);
-#endif
+                    if (Logger::IsEnabled(LOG_LEVEL::DEBUG))
+                        PrintTreeComposition(global_scope);
 
                     if (!create_new)
                     {
@@ -512,6 +805,9 @@ namespace Interpreter
                     }
 
                     scope->vars.insert({scope_name, var_val});
+                    if (is_const)
+                        scope->consts.insert(scope_name);
+                    Global::InvalidateNameCaches();
                     return Error::OK;
                 }
             }
@@ -526,7 +822,13 @@ namespace Interpreter
 
             Token::Token &varname = inst.args.at(1);
 
-            Logger::Debug("setting:", {varname.content, "in scope:", parent_scope.name});
+            LOG_DEBUG("setting:", {varname.content, "in scope:", parent_scope.name});
+
+            if (varname.content == Registers::RET_VAL_NAME)
+            {
+                Logger::Error("Syntax Error: cannot assign to read-only name", {varname.content});
+                return Error::SYNTAX;
+            }
 
             if (Helper::UnorderedMapHasKey(parent_scope.vars, varname.content))
             {
@@ -561,19 +863,17 @@ namespace Interpreter
                     values.push_back(t);
             }
 
-            Variant v = {
-                .type = VALUE_TYPE::NIL,
-                .d64 = 0,
-            };
+            Variant v = NIL_VALUE;
             Error make_err = MakeVarArray(v, values);
             if (make_err)
                 return make_err;
             parent_scope.vars.insert({varname.content, v});
+            Global::InvalidateNameCaches();
             return Error::OK;
         }
         case Token::KEYW_CALL:
         {
-            Error call_err = FunctionCall(inst, parent_scope, global_scope);
+            Error call_err = FunctionCall(inst, 0, parent_scope, global_scope);
             if (call_err)
                 return call_err;
             return Error::OK;
@@ -591,7 +891,7 @@ namespace Interpreter
             Token::Token &path = inst.args.at(1);
             Token::Token &alias = inst.args.at(3);
 
-            Logger::Debug("IMPORT", {path.content, alias.content});
+            LOG_DEBUG("IMPORT", {path.content, alias.content});
 
             if (path.type != Token::STRING)
             {
@@ -608,7 +908,7 @@ namespace Interpreter
             try
             {
                 abs_path = fs::canonical(path.content);
-                Logger::Debug("Found importable file at path:", {path.content});
+                LOG_DEBUG("Found importable file at path:", {path.content});
             }
             catch ([[maybe_unused]] const std::exception &e)
             {
@@ -631,6 +931,7 @@ namespace Interpreter
                                                                     .scopes = {},
                                                                 });
             Scope &imported_global = global_scope.scopes.at(alias.content);
+            Global::InvalidateNameCaches();
 
             Error parse_err = Parser::ParseTokens(tokens, imported_global);
             if (parse_err)
@@ -647,71 +948,74 @@ namespace Interpreter
         }
         case Token::KEYW_RETURN:
         {
-            Variant v{
-                .type = VALUE_TYPE::NIL,
-                .flags = {},
-                .d64 = 0,
-            };
+            Variant v = NIL_VALUE;
 
             if (inst.args.size() < 2)
             {
-                global_scope.vars.insert_or_assign("retVal", v);
+                Registers::ret_val = v;
+                return Error::EARLY_RETURN;
+            }
+
+            if (inst.expr.size())
+            {
+                Error eval_err = EvaluateExpression(inst, parent_scope, v);
+                if (eval_err)
+                    return eval_err;
+                Registers::ret_val = v;
                 return Error::EARLY_RETURN;
             }
 
             Token::Token value = inst.args.at(1);
 
-            Error make_err = MakeVariant(v, value, false);
+            Error make_err = MakeVariant(v, value);
             if (make_err)
             {
                 Logger::Error("Could not make variant out of return value.", {});
                 return make_err;
             }
 
-            global_scope.vars.insert_or_assign("retVal", v);
+            Registers::ret_val = v;
             return Error::EARLY_RETURN;
         }
         case Token::KEYW_ELIF:
         case Token::KEYW_IF:
+        case Token::KEYW_WHILE:
         {
             if (inst.args.size() < 2)
             {
-                Logger::Error("Syntax Error: not enough arguments for instruction 'if/elif'.", {});
+                Logger::Error("Syntax Error: not enough arguments for instruction 'if/elif/while'.", {});
                 return Error::SYNTAX;
             }
 
-            Token::Token compare_func = inst.args.at(1);
-            Token::Token func_tok = Token::Token{
-                .content = "func",
-                .type = Token::KEYW_FUNC,
-            };
-            Instruction temp_func_inst = Instruction{
-                .type = Token::KEYW_FUNC,
-                .args = {func_tok},
-            };
-            for (size_t i = 1; i < inst.args.size(); ++i)
+            Variant return_val{};
+            if (inst.expr.size())
             {
-                temp_func_inst.args.push_back(inst.args.at(i));
+                Error eval_err = EvaluateExpression(inst, parent_scope, return_val);
+                if (eval_err)
+                    return eval_err;
+            }
+            else
+            {
+                Error call_err = FunctionCall(inst, 0, parent_scope, global_scope);
+                if (call_err)
+                    return call_err;
+                return_val = Registers::ret_val;
             }
-            Error call_err = FunctionCall(temp_func_inst, parent_scope, global_scope);
-            if (call_err)
-                return call_err;
-            Variant return_val = global_scope.vars.at("retVal");
 
-            if (!IsBoolConvertible(return_val.type))
+            if (!IsBoolConvertible(VarType(return_val)))
             {
-                Logger::Error("Syntax Error: Function used in 'if' instruction must return a type convertible to boolean expression (int, float, null).", {});
+                Logger::Error("Syntax Error: Condition of 'if/while' instruction must be a type convertible to boolean expression (int, float, null).", {});
                 return Error::SYNTAX;
             }
 
             bool boolean_val;
-            switch (return_val.type)
+            switch (VarType(return_val))
             {
             case VALUE_TYPE::INT:
-                boolean_val = std::bit_cast<int64_t>(return_val.d64) != 0LL;
+                boolean_val = VarGetInt(return_val) != 0LL;
                 break;
             case VALUE_TYPE::FLOAT:
-                boolean_val = std::bit_cast<double>(return_val.d64) != 0.0;
+                boolean_val = VarGetFloat(return_val) != 0.0;
                 break;
             case VALUE_TYPE::NIL:
                 boolean_val = false;
@@ -721,7 +1025,7 @@ namespace Interpreter
                 break;
             }
 
-            Logger::Debug("IF RESULT:", {std::to_string(boolean_val)});
+            LOG_DEBUG("IF RESULT:", {std::to_string(boolean_val)});
 
             if (boolean_val)
                 return Error::EXE_UPTO_IF;
@@ -744,213 +1048,441 @@ namespace Interpreter
         return Error::OK;
     }
 
-    enum class EXEC_BEHAVIOUR
+    Error ResolveLoopBound(Token::Token &tok, Scope &parent_scope, VarInt &out)
     {
-        NORMAL,
-        EXEC_UPTO_ELIF,
-        SKIP_TO_ELIF,
-        SKIP_TO_END,
-    };
+        Variant v{};
+        if (tok.type == Token::NAME)
+        {
+            v = ResolveName(tok, parent_scope);
+        }
+        else
+        {
+            Error make_err = MakeVariant(v, tok);
+            if (make_err)
+            {
+                Logger::Error("Syntax Error: expected value in 'for' instruction, got:", {tok.content});
+                return make_err;
+            }
+        }
 
-    struct Behaviour
+        if (VarType(v) != VALUE_TYPE::INT)
+        {
+            Logger::Error("Type Error: bounds and step of 'for' must be of type int, got:", {tok.content});
+            return Error::SYNTAX;
+        }
+        out = VarGetInt(v);
+        return Error::OK;
+    }
+
+    Error InitLoopCounter(Instruction &inst, Scope &parent_scope, LoopCounter &counter)
     {
-        EXEC_BEHAVIOUR type;
-        size_t from_depth;
-    };
+        Error start_err = ResolveLoopBound(inst.args.at(3), parent_scope, counter.value);
+        if (start_err)
+            return start_err;
+
+        Error end_err = ResolveLoopBound(inst.args.at(5), parent_scope, counter.end);
+        if (end_err)
+            return end_err;
+
+        counter.step = 1;
+        if (inst.args.size() >= 8)
+        {
+            Error step_err = ResolveLoopBound(inst.args.at(7), parent_scope, counter.step);
+            if (step_err)
+                return step_err;
+        }
+
+        if (counter.step == 0)
+        {
+            Logger::Error("Runtime Error: step of 'for' cannot be 0.", {});
+            return Error::REJECTED;
+        }
+        return Error::OK;
+    }
+
+    bool IsLoopCounterRunning(const LoopCounter &counter)
+    {
+        return counter.step > 0
+                   ? counter.value < counter.end
+                   : counter.value > counter.end;
+    }
 
-    void PrintBehaviourStack(std::vector<Behaviour> stack)
+    // Writes the loop register to the variable named by the 'for' instruction, declaring it if needed.
+    Error StoreLoopCounter(Instruction &for_inst, Scope &parent_scope, const LoopCounter &counter)
     {
-        std::vector<std::string> behavs{};
-        for (auto b : stack)
+        Token::Token &varname = for_inst.args.at(1);
+
+        Variant v = VarMakeInt(counter.value);
+
+        if (!IsCacheValid(varname.cache, parent_scope))
         {
-            switch (b.type)
+            if (varname.content == Registers::RET_VAL_NAME)
             {
-            case EXEC_BEHAVIOUR::NORMAL:
-                behavs.push_back("NORMAL");
-                break;
-            case EXEC_BEHAVIOUR::EXEC_UPTO_ELIF:
-                behavs.push_back("EXEC_UPTO_ELIF");
-                break;
-            case EXEC_BEHAVIOUR::SKIP_TO_ELIF:
-                behavs.push_back("SKIP_TO_ELIF");
-                break;
-            case EXEC_BEHAVIOUR::SKIP_TO_END:
-                behavs.push_back("SKIP_TO_END");
-                break;
+                Logger::Error("Syntax Error: cannot assign to read-only name", {varname.content});
+                return Error::SYNTAX;
+            }
+
+            Variant *slot = FindNameSlot(varname.content, parent_scope);
+            if (!slot)
+            {
+                parent_scope.vars.insert({varname.content, v});
+                Global::InvalidateNameCaches();
+                slot = &parent_scope.vars.at(varname.content);
+            }
+            FillCache(varname.cache, parent_scope, nullptr, slot);
+        }
+
+        *varname.cache.slot = v;
+        return Error::OK;
+    }
+
+    uint32_t JitStop(Jit::Frame *frame, Error err)
+    {
+        frame->error = err;
+        return Jit::STOP;
+    }
+
+    // Exceptions cannot unwind through compiled code, the handlers stop it and Jit::Run rethrows.
+    uint32_t JitException(Jit::Frame *frame)
+    {
+        frame->exception = std::current_exception();
+        return JitStop(frame, Error::UNHANDLED);
+    }
+
+    // Bookkeeping of every instruction of compiled code, done by the handlers and by the native templates.
+    uint32_t JitEnter(Jit::Frame *frame, uint64_t index)
+    {
+        Gc::Safepoint();
+        Registers::CurrentFrame().ip = index;
+        Trace::Record(frame->scope, index, frame->scope->instructions[index].type);
+        if (Stats::enabled)
+            Stats::CountInstruction(frame->scope->instructions[index].type);
+        return Jit::NEXT;
+    }
+
+    // Runs an instruction through the interpreter once JitEnter ran for it.
+    uint32_t JitResume(Jit::Frame *frame, uint64_t index)
+    {
+        try
+        {
+            Error inst_err = ExecuteInstruction(frame->scope->instructions[index], *frame->scope, *frame->global_scope);
+            switch (inst_err)
+            {
+            case Error::OK:
+            case Error::EXE_UPTO_IF:
+                return Jit::NEXT;
+            case Error::SKIP_TO_IF:
+                return Jit::BRANCH;
             default:
-                break;
+                return JitStop(frame, inst_err);
             }
         }
-        Logger::Debug("BEHAVIOURS:", behavs);
+        catch (...)
+        {
+            return JitException(frame);
+        }
     }
 
-    Error ExecuteScope(Scope &scope, Scope &global_scope)
+    uint32_t JitStep(Jit::Frame *frame, uint64_t index)
     {
-        scope.runtime_vars = {
-            .if_depth = 0,
-        };
+        JitEnter(frame, index);
+        return JitResume(frame, index);
+    }
 
-        std::vector<Behaviour> behaviour_stack{Behaviour{
-            .type = EXEC_BEHAVIOUR::NORMAL,
-            .from_depth = 0,
-        }};
+    uint32_t JitForInit(Jit::Frame *frame, uint64_t index)
+    {
+        JitEnter(frame, index);
 
-        for (size_t i = 0; i < scope.instructions.size(); ++i)
+        try
         {
-            Instruction &inst = scope.instructions.at(i);
-            Behaviour behav = behaviour_stack.back();
+            Instruction &inst = frame->scope->instructions[index];
+            LoopCounter &counter = frame->loop_regs[inst.reg];
 
-            switch (behav.type)
-            {
-            case EXEC_BEHAVIOUR::EXEC_UPTO_ELIF:
-            {
-                if (!inst.args.size())
-                    continue;
-                Token::TYPE inst_type = inst.args.at(0).type;
+            Error init_err = InitLoopCounter(inst, *frame->scope, counter);
+            if (init_err)
+                return JitStop(frame, init_err);
 
-                if (inst_type == Token::KEYW_IF)
-                    scope.runtime_vars.if_depth += 1;
+            if (!IsLoopCounterRunning(counter))
+                return Jit::BRANCH;
 
-                if (behav.from_depth == scope.runtime_vars.if_depth && (inst_type == Token::KEYW_ELIF || inst_type == Token::KEYW_ELSE))
-                {
-                    behaviour_stack.pop_back();
-                    behaviour_stack.push_back(Behaviour{
-                        .type = EXEC_BEHAVIOUR::SKIP_TO_END,
-                        .from_depth = scope.runtime_vars.if_depth,
-                    });
-                    PrintBehaviourStack(behaviour_stack);
-                    continue;
-                }
-                else if (behav.from_depth == scope.runtime_vars.if_depth && inst_type == Token::KEYW_ENDIF)
-                {
-                    scope.runtime_vars.if_depth -= 1;
-                    behaviour_stack.pop_back();
-                    PrintBehaviourStack(behaviour_stack);
-                    continue;
-                }
+            Error store_err = StoreLoopCounter(inst, *frame->scope, counter);
+            if (store_err)
+                return JitStop(frame, store_err);
+            return Jit::NEXT;
+        }
+        catch (...)
+        {
+            return JitException(frame);
+        }
+    }
 
-                if (inst_type == Token::KEYW_ENDIF)
-                    scope.runtime_vars.if_depth -= 1;
-            }
-            case EXEC_BEHAVIOUR::SKIP_TO_ELIF:
-            {
-                if (behav.type == EXEC_BEHAVIOUR::SKIP_TO_ELIF)
-                {
-                    if (!inst.args.size())
-                        continue;
+    uint32_t JitForStep(Jit::Frame *frame, uint64_t index)
+    {
+        JitEnter(frame, index);
+
+        try
+        {
+            Instruction &inst = frame->scope->instructions[index];
+            LoopCounter &counter = frame->loop_regs[inst.reg];
+            counter.value += counter.step;
 
-                    Token::TYPE inst_type = inst.args.at(0).type;
-                    bool fallthrough = false;
+            if (!IsLoopCounterRunning(counter))
+                return Jit::NEXT;
 
-                    if (inst_type == Token::KEYW_IF)
-                        scope.runtime_vars.if_depth += 1;
+            Error store_err = StoreLoopCounter(frame->scope->instructions[inst.jump], *frame->scope, counter);
+            if (store_err)
+                return JitStop(frame, store_err);
+            return Jit::BRANCH;
+        }
+        catch (...)
+        {
+            return JitException(frame);
+        }
+    }
 
-                    if (behav.from_depth == scope.runtime_vars.if_depth && (inst_type == Token::KEYW_ELIF || inst_type == Token::KEYW_ELSE))
-                    {
-                        behaviour_stack.pop_back();
-                        behaviour_stack.push_back(Behaviour{
-                            .type = EXEC_BEHAVIOUR::EXEC_UPTO_ELIF,
-                            .from_depth = scope.runtime_vars.if_depth,
-                        });
-                        PrintBehaviourStack(behaviour_stack);
-                        fallthrough = true;
-                    }
-                    else if (behav.from_depth == scope.runtime_vars.if_depth && inst_type == Token::KEYW_ENDIF)
-                    {
-                        scope.runtime_vars.if_depth -= 1;
-                        behaviour_stack.pop_back();
-                        PrintBehaviourStack(behaviour_stack);
-                        continue;
-                    }
+    uint32_t JitCallBuiltin(Jit::Frame *frame, uint64_t index, BuiltinFuncs::BuiltinFunc func)
+    {
+        if (!Jit::RevalidateBuiltins(*frame->scope, *frame->global_scope))
+            return JitStep(frame, index);
 
-                    if (inst_type == Token::KEYW_ENDIF)
-                        scope.runtime_vars.if_depth -= 1;
+        Gc::Safepoint();
+        Registers::CurrentFrame().ip = index;
+        Trace::Record(frame->scope, index, Token::KEYW_CALL);
 
-                    if (!fallthrough)
-                        continue;
-                }
-            }
-            case EXEC_BEHAVIOUR::NORMAL:
+        if (Stats::enabled)
+            Stats::CountInstruction(Token::KEYW_CALL);
+
+        try
+        {
+            Error call_err = CallBuiltin(func, frame->scope->instructions[index], 3, *frame->scope);
+            if (call_err)
+                return JitStop(frame, call_err);
+            return Jit::NEXT;
+        }
+        catch (...)
+        {
+            return JitException(frame);
+        }
+    }
+
+    const Jit::Handlers JIT_HANDLERS{
+        .step = JitStep,
+        .for_init = JitForInit,
+        .for_step = JitForStep,
+        .builtin = JitCallBuiltin,
+        .enter = JitEnter,
+        .resume = JitResume,
+    };
+
+    // Counts calls of a function scope and compiles it once it gets hot.
+    bool IsJitReady(Scope &scope, Scope &global_scope)
+    {
+        if (!Jit::enabled || scope.type != SCOPE_TYPE::FUNC || scope.jit.disabled)
+            return false;
+
+        if (scope.jit.entry)
+            return true;
+
+        if (++scope.jit.calls < Jit::threshold)
+            return false;
+
+        if (Jit::Compile(scope, global_scope, JIT_HANDLERS))
+        {
+            scope.jit.disabled = true;
+            return false;
+        }
+        return true;
+    }
+
+    Error RunScope(Scope &scope, Scope &global_scope, LoopCounter *loop_regs)
+    {
+        if (IsJitReady(scope, global_scope))
+        {
+            Error jit_err = Jit::Run(scope, global_scope, loop_regs);
+            if (jit_err == Error::EARLY_RETURN)
+                return Error::OK;
+            return jit_err;
+        }
+
+        // Set when a false condition jumped to the next elif/else/endif of its chain.
+        bool branch_entry = false;
+        CallFrame &frame = Registers::CurrentFrame();
+
+        size_t i = 0;
+        while (i < scope.instructions.size())
+        {
+            Instruction &inst = scope.instructions[i];
+            frame.ip = i;
+            Trace::Record(&scope, i, inst.type);
+            Gc::Safepoint();
+
+            if (Stats::enabled)
+                Stats::CountInstruction(inst.type);
+
+            switch (inst.type)
             {
-                Error inst_err = ExecuteInstruction(inst, scope, global_scope);
-                if (inst_err == Error::EARLY_RETURN)
-                    return Error::OK;
-                if (inst_err == Error::SKIP_TO_IF)
+            case Token::KEYW_ELIF:
+            case Token::KEYW_ELSE:
+            {
+                // Reached from the end of the previous branch, leave the chain.
+                if (!branch_entry)
                 {
-                    behaviour_stack.push_back(Behaviour{
-                        .type = EXEC_BEHAVIOUR::SKIP_TO_ELIF,
-                        .from_depth = scope.runtime_vars.if_depth,
-                    });
-                    PrintBehaviourStack(behaviour_stack);
+                    i = inst.exit;
                     continue;
                 }
-                if (inst_err == Error::SKIP_TO_END)
+                branch_entry = false;
+                if (inst.type == Token::KEYW_ELSE)
                 {
-                    behaviour_stack.push_back(Behaviour{
-                        .type = EXEC_BEHAVIOUR::SKIP_TO_END,
-                        .from_depth = scope.runtime_vars.if_depth,
-                    });
-                    PrintBehaviourStack(behaviour_stack);
+                    ++i;
                     continue;
                 }
-                if (inst_err == Error::EXE_UPTO_IF)
+                break;
+            }
+            case Token::KEYW_ENDIF:
+            {
+                branch_entry = false;
+                ++i;
+                continue;
+            }
+            case Token::KEYW_ENDWHILE:
+            case Token::KEYW_CONTINUE:
+            {
+                i = inst.jump;
+                continue;
+            }
+            case Token::KEYW_BREAK:
+            {
+                i = inst.exit;
+                continue;
+            }
+            case Token::KEYW_FOR:
+            {
+                LoopCounter &counter = loop_regs[inst.reg];
+                Error init_err = InitLoopCounter(inst, scope, counter);
+                if (init_err)
+                    return init_err;
+
+                if (!IsLoopCounterRunning(counter))
                 {
-                    if (behav.type == EXEC_BEHAVIOUR::SKIP_TO_ELIF)
-                    {
-                        behaviour_stack.pop_back();
-                        PrintBehaviourStack(behaviour_stack);
-                    }
-                    behaviour_stack.push_back(Behaviour{
-                        .type = EXEC_BEHAVIOUR::EXEC_UPTO_ELIF,
-                        .from_depth = scope.runtime_vars.if_depth,
-                    });
-                    PrintBehaviourStack(behaviour_stack);
+                    i = inst.exit;
                     continue;
                 }
-                if (inst_err)
-                {
-                    Logger::Debug("SCOPE ERROR:", {std::to_string(inst_err)});
-                    return inst_err;
-                }
+
+                Error store_err = StoreLoopCounter(inst, scope, counter);
+                if (store_err)
+                    return store_err;
+                ++i;
                 continue;
             }
-            case EXEC_BEHAVIOUR::SKIP_TO_END:
+            case Token::KEYW_ENDFOR:
             {
-                if (!inst.args.size())
-                    continue;
-                Token::TYPE inst_type = inst.args.at(0).type;
+                LoopCounter &counter = loop_regs[inst.reg];
+                counter.value += counter.step;
 
-                if (inst_type == Token::KEYW_IF)
-                    scope.runtime_vars.if_depth += 1;
-
-                if (inst_type == Token::KEYW_ENDIF)
+                if (!IsLoopCounterRunning(counter))
                 {
-                    Logger::Debug("FOUND ENDIF", {});
-                    if (behav.from_depth == scope.runtime_vars.if_depth)
-                    {
-                        behaviour_stack.pop_back();
-                        PrintBehaviourStack(behaviour_stack);
-                    }
-                    else
-                    {
-                        Logger::Debug("NOT SAME DEPTH.", {});
-                    }
+                    ++i;
+                    continue;
                 }
 
-                if (inst_type == Token::KEYW_ENDIF)
-                    scope.runtime_vars.if_depth -= 1;
+                Error store_err = StoreLoopCounter(scope.instructions[inst.jump], scope, counter);
+                if (store_err)
+                    return store_err;
+                i = inst.jump + 1;
                 continue;
             }
             default:
                 break;
             }
+
+            Error inst_err = ExecuteInstruction(inst, scope, global_scope);
+            if (inst_err == Error::EARLY_RETURN)
+                return Error::OK;
+            if (inst_err == Error::SKIP_TO_IF)
+            {
+                if (inst.type == Token::KEYW_WHILE)
+                {
+                    i = inst.exit;
+                }
+                else
+                {
+                    i = inst.jump;
+                    branch_entry = true;
+                }
+                continue;
+            }
+            if (inst_err == Error::EXE_UPTO_IF)
+            {
+                ++i;
+                continue;
+            }
+            if (inst_err)
+            {
+                LOG_DEBUG("SCOPE ERROR:", {std::to_string(inst_err)});
+                return inst_err;
+            }
+            ++i;
         }
         return Error::OK;
     }
 
+    // Frees the arena strings of a frame, those still held by its variables or returned move to the store.
+    void ReleaseArena(Scope &scope, size_t mark)
+    {
+        if (Memory::arena_top == mark)
+            return;
+
+        for (auto &[name, value] : scope.vars)
+            VarPromote(value);
+        for (auto &[name, value] : scope.args)
+            VarPromote(value);
+        VarPromote(Registers::ret_val);
+        Memory::arena_top = mark;
+    }
+
+    // Runs a scope with its loop counters taken from the loop register stack.
+    Error ExecuteScope(Scope &scope, Scope &global_scope)
+    {
+        if (Registers::loop_top + scope.loop_depth > Registers::LOOP_STACK_SIZE)
+        {
+            Logger::Error("Runtime Error: loop register stack overflow in", {scope.name});
+            return Error::REJECTED;
+        }
+
+        size_t depth = Registers::frame_depth.load(std::memory_order_relaxed);
+        if (depth == Registers::MAX_CALL_DEPTH)
+        {
+            Logger::Error("Runtime Error: call stack overflow in", {scope.name});
+            return Error::REJECTED;
+        }
+
+        bool profiled = Stats::enabled && scope.type == SCOPE_TYPE::FUNC;
+        if (profiled)
+            Stats::EnterFunction(scope);
+
+        Registers::frames[depth] = CallFrame{
+            .scope = &scope,
+            .ip = 0,
+        };
+        Registers::frame_depth.store(depth + 1, std::memory_order_release);
+
+        LoopCounter *loop_regs = &Registers::loop_stack[Registers::loop_top];
+        size_t arena_mark = Memory::arena_top;
+        Registers::loop_top += scope.loop_depth;
+        Error exec_err = RunScope(scope, global_scope, loop_regs);
+        Registers::loop_top -= scope.loop_depth;
+        ReleaseArena(scope, arena_mark);
+
+        Registers::frame_depth.store(depth, std::memory_order_release);
+
+        if (profiled)
+            Stats::LeaveFunction();
+        return exec_err;
+    }
+
     Error RecursiveScopeExecutor(Scope &current_scope, Scope &global_scope)
     {
-        Logger::Debug("Recursing over scopes in:", {current_scope.name});
+        LOG_DEBUG("Recursing over scopes in:", {current_scope.name});
         Error retval = Error::OK;
         for (auto &[key, val] : current_scope.scopes)
         {
@@ -960,7 +1492,7 @@ namespace Interpreter
             if (val.name.starts_with("#"))
                 continue;
 
-            Logger::Debug("Executing scope:", {"key:", key, "name:", val.name});
+            LOG_DEBUG("Executing scope:", {"key:", key, "name:", val.name});
             Error exe_err = ExecuteScope(val, global_scope);
             if (exe_err)
             {
@@ -971,17 +1503,17 @@ namespace Interpreter
             retval = RecursiveScopeExecutor(val, global_scope);
             if (retval)
             {
-                Logger::Debug("Finished executing scope due to error.", {});
+                LOG_DEBUG("Finished executing scope due to error.", {});
                 return retval;
             }
         }
-        Logger::Debug("Finished executing scope:", {current_scope.name});
+        LOG_DEBUG("Finished executing scope:", {current_scope.name});
         return Error::OK;
     }
 
     Error InterpretGlobalScope(Scope &global_scope)
     {
-        Logger::Debug("Starting Interpretation...", {});
+        LOG_DEBUG("Starting Interpretation...", {});
 
         if (!Helper::UnorderedMapHasKey(global_scope.scopes, std::string{"Main"}))
         {
@@ -989,21 +1521,10 @@ namespace Interpreter
             return Error::SYNTAX;
         }
 
-        Variant default_retval{
-            .type = VALUE_TYPE::NIL,
-            .flags = {},
-            .d64 = 0,
-        };
-        global_scope.vars.insert_or_assign("retVal", default_retval);
-
-        Variant null{
-            .type = VALUE_TYPE::NIL,
-            .flags = {
-                .is_const = true,
-            },
-            .d64 = 0,
-        };
-        global_scope.vars.insert_or_assign("null", null);
+        Registers::Reset();
+
+        global_scope.vars.insert_or_assign("null", NIL_VALUE);
+        global_scope.consts.insert("null");
 
         Scope &main = global_scope.scopes.at("Main");
 
@@ -1013,24 +1534,24 @@ namespace Interpreter
             return Error::SYNTAX;
         }
 
-        Logger::Debug("Executing Global Scope.", {});
+        LOG_DEBUG("Executing Global Scope.", {});
         Error exe_err = ExecuteScope(global_scope, global_scope);
         if (exe_err)
             return exe_err;
 
-        Logger::Debug("Scopes in global:", {std::to_string(global_scope.scopes.size())});
+        LOG_DEBUG("Scopes in global:", {std::to_string(global_scope.scopes.size())});
 
-        Logger::Debug("Executing Nested Scopes.", {});
+        LOG_DEBUG("Executing Nested Scopes.", {});
         Error scope_exe_err = RecursiveScopeExecutor(global_scope, global_scope);
         if (scope_exe_err)
             return scope_exe_err;
 
-        Logger::Debug("Executing Main.", {});
+        LOG_DEBUG("Executing Main.", {});
         Error main_err = ExecuteScope(main, global_scope);
         if (main_err)
             return main_err;
 
-        Logger::Debug("Finished Interpretation.", {});
+        LOG_DEBUG("Finished Interpretation.", {});
 
         return Error::OK;
     }
@@ -0,0 +1,836 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "../logger/logger.hpp"
+#include "../helper/helper.hpp"
+#include "../global_state/global_state.hpp"
+
+#include "../types/error.hpp"
+#include "../types/token.hpp"
+#include "../types/scope.hpp"
+#include "../types/loop_counter.hpp"
+#include "../types/expression.hpp"
+#include "../registers/registers.hpp"
+#include "../operators/operators.hpp"
+#include "../builtin/builtin_funcs.hpp"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define GVS_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#else
+#define GVS_JIT_SUPPORTED 0
+#endif
+
+// Baseline template JIT for function scopes.
+// Control flow between instructions (if/elif/else chains, loops, break/continue) becomes native jumps.
+// 'set' and if/elif/while conditions computed from int and float operands get machine code
+// templates, every other instruction becomes a call to a runtime handler running the interpreter.
+namespace Jit
+{
+    // Calls a function scope makes interpreted before it gets compiled.
+    const size_t DEFAULT_THRESHOLD = 100;
+
+    bool enabled = false;
+    size_t threshold = DEFAULT_THRESHOLD;
+
+    // State of one execution of compiled code.
+    struct Frame
+    {
+        Scope *scope;
+        Scope *global_scope;
+        LoopCounter *loop_regs;
+        // Error which stopped the code, OK when it ran to the end.
+        Error error;
+        // Exception caught by a handler, rethrown by Run once the compiled code has returned.
+        std::exception_ptr exception;
+    };
+
+    // Handler results, read by the compiled code after each call.
+    const uint32_t NEXT = 0;
+    const uint32_t BRANCH = 1;
+    const uint32_t STOP = 2;
+
+    using StepHandler = uint32_t (*)(Frame *frame, uint64_t index);
+    using BuiltinHandler = uint32_t (*)(Frame *frame, uint64_t index, BuiltinFuncs::BuiltinFunc func);
+
+    struct Handlers
+    {
+        // Runs any instruction through the interpreter, BRANCH when a condition was false.
+        StepHandler step;
+        // BRANCH when the loop has no iteration to run.
+        StepHandler for_init;
+        // BRANCH when the loop runs another iteration.
+        StepHandler for_step;
+        BuiltinHandler builtin;
+        // Bookkeeping done before any instruction: safepoint, call frame ip, trace and stats.
+        StepHandler enter;
+        // Runs an instruction through the interpreter once 'enter' ran, taken when a template check fails.
+        StepHandler resume;
+    };
+
+    using EntryPoint = void (*)(Frame *frame);
+
+    bool IsSupported()
+    {
+        return GVS_JIT_SUPPORTED;
+    }
+
+    // Builtin call sites are compiled only while no scope shadows the builtin name.
+    bool IsBuiltinCallSite(const Instruction &inst, const Scope &scope, const Scope &global_scope)
+    {
+        if (inst.type != Token::KEYW_CALL || inst.args.size() < 2)
+            return false;
+
+        const std::string &name = inst.args.at(1).content;
+        return !Helper::StringContains(name, '.') &&
+               !Helper::UnorderedMapHasKey(scope.scopes, name) &&
+               !Helper::UnorderedMapHasKey(global_scope.scopes, name) &&
+               BuiltinFuncs::IsBuiltIn(name);
+    }
+
+    // Checks the builtin call sites after scopes were added at runtime, disables the code when one got shadowed.
+    bool RevalidateBuiltins(Scope &scope, const Scope &global_scope)
+    {
+        if (scope.jit.version == Global::scope_tree_version)
+            return true;
+
+        for (size_t site : scope.jit.builtin_sites)
+        {
+            if (!IsBuiltinCallSite(scope.instructions.at(site), scope, global_scope))
+            {
+                scope.jit.disabled = true;
+                return false;
+            }
+        }
+        scope.jit.version = Global::scope_tree_version;
+        return true;
+    }
+
+#if GVS_JIT_SUPPORTED
+    namespace
+    {
+        enum class TARGET : uint8_t
+        {
+            LABEL,
+            ENTRY,
+            EXIT,
+            // Interpreter fallback of a native template.
+            FALLBACK,
+        };
+
+        // rel32 operand to patch once every label is placed.
+        struct Fixup
+        {
+            size_t at;
+            TARGET target;
+            size_t index;
+        };
+
+        struct Assembler
+        {
+            std::vector<uint8_t> code;
+            std::vector<Fixup> fixups;
+            // Offset of the interpreter fallback of each instruction compiled to a native template.
+            std::vector<size_t> fallbacks;
+        };
+
+        void Emit(Assembler &as, std::initializer_list<uint8_t> bytes)
+        {
+            as.code.insert(as.code.end(), bytes);
+        }
+
+        void EmitImm32(Assembler &as, uint32_t imm)
+        {
+            for (size_t i = 0; i < 4; ++i)
+                as.code.push_back(static_cast<uint8_t>(imm >> (i * 8)));
+        }
+
+        void EmitImm64(Assembler &as, uint64_t imm)
+        {
+            for (size_t i = 0; i < 8; ++i)
+                as.code.push_back(static_cast<uint8_t>(imm >> (i * 8)));
+        }
+
+        void EmitRel32(Assembler &as, TARGET target, size_t index)
+        {
+            as.fixups.push_back(Fixup{
+                .at = as.code.size(),
+                .target = target,
+                .index = index,
+            });
+            EmitImm32(as, 0);
+        }
+
+        // jmp rel32
+        void EmitJump(Assembler &as, TARGET target, size_t index)
+        {
+            Emit(as, {0xE9});
+            EmitRel32(as, target, index);
+        }
+
+        // Jcc rel32, 'cc' is the second opcode byte (0x80 jo, 0x84 je, 0x85 jne, 0x87 ja).
+        void EmitJumpIf(Assembler &as, uint8_t cc, TARGET target, size_t index)
+        {
+            Emit(as, {0x0F, cc});
+            EmitRel32(as, target, index);
+        }
+
+        // handler(frame, index[, extra]), the frame pointer lives in rbx.
+        void EmitHandlerCall(Assembler &as, const void *handler, size_t index, const void *extra = nullptr)
+        {
+            Emit(as, {0x48, 0x89, 0xDF}); // mov rdi, rbx
+            Emit(as, {0xBE});             // mov esi, imm32
+            EmitImm32(as, static_cast<uint32_t>(index));
+            if (extra)
+            {
+                Emit(as, {0x48, 0xBA}); // mov rdx, imm64
+                EmitImm64(as, reinterpret_cast<uint64_t>(extra));
+            }
+            Emit(as, {0x48, 0xB8}); // mov rax, imm64
+            EmitImm64(as, reinterpret_cast<uint64_t>(handler));
+            Emit(as, {0xFF, 0xD0}); // call rax
+        }
+
+        // Stops on STOP, jumps to 'target' on BRANCH, falls through on NEXT.
+        void EmitBranchOnResult(Assembler &as, TARGET target, size_t index)
+        {
+            Emit(as, {0x83, 0xF8, static_cast<uint8_t>(BRANCH)}); // cmp eax, BRANCH
+            EmitJumpIf(as, 0x84, target, index);                  // je target
+            EmitJumpIf(as, 0x87, TARGET::EXIT, 0);                // ja exit
+        }
+
+        void EmitStopOnResult(Assembler &as)
+        {
+            Emit(as, {0x85, 0xC0});                // test eax, eax
+            EmitJumpIf(as, 0x85, TARGET::EXIT, 0); // jne exit
+        }
+
+        // Where a false if/elif condition continues: the condition of the next elif,
+        // or the first instruction of the else branch or after endif.
+        TARGET FalseTarget(const std::vector<Instruction> &insts, size_t next)
+        {
+            return insts.at(next).type == Token::KEYW_ELIF ? TARGET::ENTRY : TARGET::LABEL;
+        }
+
+        size_t FalseTargetIndex(const std::vector<Instruction> &insts, size_t next)
+        {
+            return insts.at(next).type == Token::KEYW_ELIF ? next : next + 1;
+        }
+
+        void EmitFalseBranch(Assembler &as, const std::vector<Instruction> &insts, size_t next)
+        {
+            EmitBranchOnResult(as, FalseTarget(insts, next), FalseTargetIndex(insts, next));
+        }
+
+        // Native templates keep expression values on the machine stack as raw int64 or double bits.
+        // Types are fixed at compile time by the quickened ops and checked where a variable is read,
+        // a failed check restores rsp from r12 and runs the instruction through the interpreter.
+        // Nothing is written before the last check, so the interpreter starts from a clean state.
+        const uint8_t RAX = 0;
+        const uint8_t RCX = 1;
+        const uint8_t RDX = 2;
+
+        const uint64_t INT_BOX_BITS = Packed::Box(Packed::TAG::INT, 0).bits;
+        const uint32_t INT_BOX_TOP = static_cast<uint32_t>(INT_BOX_BITS >> 48);
+        // Bits 51-63 are all set in a box and never in a canonical double.
+        const uint32_t BOX_PREFIX_TOP = static_cast<uint32_t>(Packed::BOX_PREFIX >> 51);
+
+        static_assert(offsetof(NameCache, field) < 128, "NameCache fields are reached with 8 bit displacements");
+
+        // mov reg, imm64
+        void EmitMovImm64(Assembler &as, uint8_t reg, uint64_t imm)
+        {
+            Emit(as, {0x48, static_cast<uint8_t>(0xB8 + reg)});
+            EmitImm64(as, imm);
+        }
+
+        void EmitFallbackIf(Assembler &as, uint8_t cc, size_t index)
+        {
+            EmitJumpIf(as, cc, TARGET::FALLBACK, index);
+        }
+
+        // rcx = the variable slot of 'cache', falls back while the cache is stale or names a struct field.
+        // Leaves rax untouched.
+        void EmitCachedSlot(Assembler &as, const NameCache &cache, const Scope &scope, size_t index)
+        {
+            EmitMovImm64(as, RCX, reinterpret_cast<uint64_t>(&cache));
+            EmitMovImm64(as, RDX, reinterpret_cast<uint64_t>(&Global::scope_tree_version));
+            Emit(as, {0x48, 0x8B, 0x12}); // mov rdx, [rdx]
+            Emit(as, {0x48, 0x3B, 0x51, static_cast<uint8_t>(offsetof(NameCache, version))}); // cmp rdx, [rcx + version]
+            EmitFallbackIf(as, 0x85, index);
+            EmitMovImm64(as, RDX, reinterpret_cast<uint64_t>(&scope));
+            Emit(as, {0x48, 0x3B, 0x51, static_cast<uint8_t>(offsetof(NameCache, context))}); // cmp rdx, [rcx + context]
+            EmitFallbackIf(as, 0x85, index);
+            Emit(as, {0x83, 0x79, static_cast<uint8_t>(offsetof(NameCache, field)), 0xFF}); // cmp dword [rcx + field], NO_FIELD
+            EmitFallbackIf(as, 0x85, index);
+            Emit(as, {0x48, 0x8B, 0x49, static_cast<uint8_t>(offsetof(NameCache, slot))}); // mov rcx, [rcx + slot]
+        }
+
+        // rax = the bits of the variable of 'cache'.
+        void EmitLoadName(Assembler &as, const NameCache &cache, const Scope &scope, size_t index)
+        {
+            EmitCachedSlot(as, cache, scope, index);
+            Emit(as, {0x48, 0x8B, 0x01}); // mov rax, [rcx]
+        }
+
+        // Falls back unless rax holds an int within 48 bits, then sign extends it.
+        void EmitUnboxInt(Assembler &as, size_t index)
+        {
+            Emit(as, {0x48, 0x89, 0xC2}); // mov rdx, rax
+            Emit(as, {0x48, 0xC1, 0xEA, 48}); // shr rdx, 48
+            Emit(as, {0x81, 0xFA});       // cmp edx, imm32
+            EmitImm32(as, INT_BOX_TOP);
+            EmitFallbackIf(as, 0x85, index);
+            Emit(as, {0x48, 0xC1, 0xE0, 16}); // shl rax, 16
+            Emit(as, {0x48, 0xC1, 0xF8, 16}); // sar rax, 16
+        }
+
+        // Falls back unless rax holds a double.
+        void EmitCheckFloat(Assembler &as, size_t index)
+        {
+            Emit(as, {0x48, 0x89, 0xC2}); // mov rdx, rax
+            Emit(as, {0x48, 0xC1, 0xEA, 51}); // shr rdx, 51
+            Emit(as, {0x81, 0xFA});       // cmp edx, imm32
+            EmitImm32(as, BOX_PREFIX_TOP);
+            EmitFallbackIf(as, 0x84, index);
+        }
+
+        // Falls back unless rax holds an int within 48 bits or a double, copied as they are.
+        void EmitCheckNumber(Assembler &as, size_t index)
+        {
+            Emit(as, {0x48, 0x89, 0xC2}); // mov rdx, rax
+            Emit(as, {0x48, 0xC1, 0xEA, 48}); // shr rdx, 48
+            Emit(as, {0x81, 0xFA});       // cmp edx, imm32
+            EmitImm32(as, INT_BOX_TOP);
+            Emit(as, {0x74, 15});         // je past the float check
+            Emit(as, {0xC1, 0xEA, 3});    // shr edx, 3
+            Emit(as, {0x81, 0xFA});       // cmp edx, imm32
+            EmitImm32(as, BOX_PREFIX_TOP);
+            EmitFallbackIf(as, 0x84, index);
+        }
+
+        // Falls back when the int in rax needs more than 48 bits, the interpreter boxes it.
+        void EmitCheckInt48(Assembler &as, size_t index)
+        {
+            Emit(as, {0x48, 0x89, 0xC2}); // mov rdx, rax
+            Emit(as, {0x48, 0xC1, 0xE2, 16}); // shl rdx, 16
+            Emit(as, {0x48, 0xC1, 0xFA, 16}); // sar rdx, 16
+            Emit(as, {0x48, 0x39, 0xC2}); // cmp rdx, rax
+            EmitFallbackIf(as, 0x85, index);
+        }
+
+        // Turns the raw result in rax into the bits of its Variant.
+        void EmitBoxResult(Assembler &as, VALUE_TYPE type)
+        {
+            if (type == VALUE_TYPE::INT)
+            {
+                EmitMovImm64(as, RDX, Packed::PAYLOAD_MASK);
+                Emit(as, {0x48, 0x21, 0xD0}); // and rax, rdx
+                EmitMovImm64(as, RDX, INT_BOX_BITS);
+                Emit(as, {0x48, 0x09, 0xD0}); // or rax, rdx
+                return;
+            }
+            // Any NaN becomes the canonical one, as in Packed::FromDouble.
+            Emit(as, {0x66, 0x48, 0x0F, 0x6E, 0xC0}); // movq xmm0, rax
+            Emit(as, {0x66, 0x0F, 0x2E, 0xC0});       // ucomisd xmm0, xmm0
+            Emit(as, {0x7B, 10});                     // jnp past the mov
+            EmitMovImm64(as, RAX, Packed::CANONICAL_NAN);
+        }
+
+        bool IsNativeBinary(const ExprOp &op)
+        {
+            switch (op.code)
+            {
+            case OPCODE::ADD:
+            case OPCODE::SUB:
+            case OPCODE::MUL:
+            case OPCODE::LT:
+            case OPCODE::GT:
+            case OPCODE::LE:
+            case OPCODE::GE:
+            case OPCODE::EQ:
+            case OPCODE::NE:
+                return op.quick == QUICK::INT_INT || op.quick == QUICK::FLOAT_FLOAT;
+            case OPCODE::DIV:
+                // Int division and modulo keep their zero checks in the interpreter.
+                return op.quick == QUICK::FLOAT_FLOAT;
+            default:
+                return false;
+            }
+        }
+
+        // Type of a constant a template can embed, NIL for the others.
+        VALUE_TYPE NativeConstType(const Variant &v)
+        {
+            if (Packed::IsDouble(v))
+                return VALUE_TYPE::FLOAT;
+            if (Packed::TagOf(v) == Packed::TAG::INT)
+                return VALUE_TYPE::INT;
+            return VALUE_TYPE::NIL;
+        }
+
+        // Type every op of 'expr' leaves on the stack, INT or FLOAT.
+        // False when an op is not quickened to ints or floats or the types do not chain.
+        bool PlanExpression(const std::vector<ExprOp> &expr, std::vector<VALUE_TYPE> &types)
+        {
+            size_t count = expr.size();
+            std::vector<size_t> lhs(count, 0);
+            std::vector<size_t> rhs(count, 0);
+            std::vector<size_t> stack{};
+            types.assign(count, VALUE_TYPE::NIL);
+
+            // Bottom up, a name gets its type from the op using it.
+            for (size_t i = 0; i < count; ++i)
+            {
+                const ExprOp &op = expr[i];
+                switch (op.code)
+                {
+                case OPCODE::PUSH_CONST:
+                    types[i] = NativeConstType(op.value);
+                    if (types[i] == VALUE_TYPE::NIL)
+                        return false;
+                    stack.push_back(i);
+                    break;
+                case OPCODE::PUSH_NAME:
+                    stack.push_back(i);
+                    break;
+                case OPCODE::NEG:
+                    if (stack.empty())
+                        return false;
+                    lhs[i] = stack.back();
+                    types[i] = types[lhs[i]];
+                    stack.back() = i;
+                    break;
+                default:
+                    if (stack.size() < 2 || !IsNativeBinary(op))
+                        return false;
+                    rhs[i] = stack.back();
+                    stack.pop_back();
+                    lhs[i] = stack.back();
+                    stack.back() = i;
+                    types[i] = Operators::IsArithmetic(op.code) && op.quick == QUICK::FLOAT_FLOAT
+                                   ? VALUE_TYPE::FLOAT
+                                   : VALUE_TYPE::INT;
+                    break;
+                }
+            }
+            if (stack.size() != 1 || types[count - 1] == VALUE_TYPE::NIL)
+                return false;
+
+            // Top down, operands take the type their op was quickened for.
+            auto require = [&types](size_t operand, VALUE_TYPE type)
+            {
+                if (types[operand] == VALUE_TYPE::NIL)
+                    types[operand] = type;
+                return types[operand] == type;
+            };
+            for (size_t i = count; i-- > 0;)
+            {
+                const ExprOp &op = expr[i];
+                if (op.code == OPCODE::NEG && !require(lhs[i], types[i]))
+                    return false;
+                if (op.code != OPCODE::NEG && op.code != OPCODE::PUSH_CONST && op.code != OPCODE::PUSH_NAME)
+                {
+                    VALUE_TYPE operand = op.quick == QUICK::INT_INT ? VALUE_TYPE::INT : VALUE_TYPE::FLOAT;
+                    if (!require(lhs[i], operand) || !require(rhs[i], operand))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        void EmitIntBinary(Assembler &as, OPCODE code, size_t index)
+        {
+            switch (code)
+            {
+            case OPCODE::ADD:
+                Emit(as, {0x48, 0x01, 0xC8}); // add rax, rcx
+                EmitCheckInt48(as, index);
+                return;
+            case OPCODE::SUB:
+                Emit(as, {0x48, 0x29, 0xC8}); // sub rax, rcx
+                EmitCheckInt48(as, index);
+                return;
+            case OPCODE::MUL:
+                Emit(as, {0x48, 0x0F, 0xAF, 0xC1}); // imul rax, rcx
+                EmitFallbackIf(as, 0x80, index);
+                EmitCheckInt48(as, index);
+                return;
+            default:
+                break;
+            }
+
+            uint8_t setcc = 0x94;
+            switch (code)
+            {
+            case OPCODE::LT:
+                setcc = 0x9C;
+                break;
+            case OPCODE::GT:
+                setcc = 0x9F;
+                break;
+            case OPCODE::LE:
+                setcc = 0x9E;
+                break;
+            case OPCODE::GE:
+                setcc = 0x9D;
+                break;
+            case OPCODE::NE:
+                setcc = 0x95;
+                break;
+            default:
+                break;
+            }
+            Emit(as, {0x48, 0x39, 0xC8});       // cmp rax, rcx
+            Emit(as, {0x0F, setcc, 0xC0});      // setcc al
+            Emit(as, {0x0F, 0xB6, 0xC0});       // movzx eax, al
+        }
+
+        // Unordered compares, a NaN operand makes every comparison but != false as in Comparators::Ordered.
+        void EmitFloatBinary(Assembler &as, OPCODE code)
+        {
+            Emit(as, {0x66, 0x48, 0x0F, 0x6E, 0xC0}); // movq xmm0, rax
+            Emit(as, {0x66, 0x48, 0x0F, 0x6E, 0xC9}); // movq xmm1, rcx
+
+            uint8_t arith = 0;
+            switch (code)
+            {
+            case OPCODE::ADD:
+                arith = 0x58;
+                break;
+            case OPCODE::SUB:
+                arith = 0x5C;
+                break;
+            case OPCODE::MUL:
+                arith = 0x59;
+                break;
+            case OPCODE::DIV:
+                arith = 0x5E;
+                break;
+            default:
+                break;
+            }
+            if (arith)
+            {
+                Emit(as, {0xF2, 0x0F, arith, 0xC1});      // addsd/subsd/mulsd/divsd xmm0, xmm1
+                Emit(as, {0x66, 0x48, 0x0F, 0x7E, 0xC0}); // movq rax, xmm0
+                return;
+            }
+
+            switch (code)
+            {
+            case OPCODE::GT:
+            case OPCODE::GE:
+                Emit(as, {0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+                Emit(as, {0x0F, static_cast<uint8_t>(code == OPCODE::GT ? 0x97 : 0x93), 0xC0}); // seta/setae al
+                break;
+            case OPCODE::LT:
+            case OPCODE::LE:
+                Emit(as, {0x66, 0x0F, 0x2E, 0xC8}); // ucomisd xmm1, xmm0
+                Emit(as, {0x0F, static_cast<uint8_t>(code == OPCODE::LT ? 0x97 : 0x93), 0xC0}); // seta/setae al
+                break;
+            case OPCODE::EQ:
+                Emit(as, {0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+                Emit(as, {0x0F, 0x94, 0xC0});       // sete al
+                Emit(as, {0x0F, 0x9B, 0xC1});       // setnp cl
+                Emit(as, {0x20, 0xC8});             // and al, cl
+                break;
+            default:
+                Emit(as, {0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+                Emit(as, {0x0F, 0x95, 0xC0});       // setne al
+                Emit(as, {0x0F, 0x9A, 0xC1});       // setp cl
+                Emit(as, {0x08, 0xC8});             // or al, cl
+                break;
+            }
+            Emit(as, {0x0F, 0xB6, 0xC0}); // movzx eax, al
+        }
+
+        // Leaves the raw value of a planned expression in rax.
+        void EmitExpression(Assembler &as, Instruction &inst, const std::vector<VALUE_TYPE> &types, const Scope &scope, size_t index)
+        {
+            for (size_t i = 0; i < inst.expr.size(); ++i)
+            {
+                ExprOp &op = inst.expr[i];
+                switch (op.code)
+                {
+                case OPCODE::PUSH_CONST:
+                    EmitMovImm64(as, RAX, types[i] == VALUE_TYPE::INT ? static_cast<uint64_t>(Packed::Int48Of(op.value)) : op.value.bits);
+                    break;
+                case OPCODE::PUSH_NAME:
+                    EmitLoadName(as, op.name.cache, scope, index);
+                    if (types[i] == VALUE_TYPE::INT)
+                        EmitUnboxInt(as, index);
+                    else
+                        EmitCheckFloat(as, index);
+                    break;
+                case OPCODE::NEG:
+                    Emit(as, {0x58}); // pop rax
+                    if (types[i] == VALUE_TYPE::INT)
+                    {
+                        Emit(as, {0x48, 0xF7, 0xD8}); // neg rax
+                        EmitCheckInt48(as, index);
+                    }
+                    else
+                    {
+                        EmitMovImm64(as, RCX, 1ULL << 63);
+                        Emit(as, {0x48, 0x31, 0xC8}); // xor rax, rcx
+                    }
+                    break;
+                default:
+                    Emit(as, {0x59}); // pop rcx
+                    Emit(as, {0x58}); // pop rax
+                    if (op.quick == QUICK::INT_INT)
+                        EmitIntBinary(as, op.code, index);
+                    else
+                        EmitFloatBinary(as, op.code);
+                    break;
+                }
+                Emit(as, {0x50}); // push rax
+            }
+            Emit(as, {0x58}); // pop rax
+        }
+
+        void EmitNativeEntry(Assembler &as, const Handlers &handlers, size_t index)
+        {
+            EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.enter), index);
+            Emit(as, {0x49, 0x89, 0xE4}); // mov r12, rsp
+        }
+
+        // Ends the native path at the next instruction and places the fallback, which leaves the handler result in eax.
+        void EmitNativeFallback(Assembler &as, const Handlers &handlers, size_t index)
+        {
+            EmitJump(as, TARGET::LABEL, index + 1);
+            as.fallbacks[index] = as.code.size();
+            Emit(as, {0x4C, 0x89, 0xE4}); // mov rsp, r12
+            EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.resume), index);
+        }
+
+        // 'set name, value' with an int or float value. 'var' and 'const' declare their name and run once per scope,
+        // they stay with the interpreter. False when no template applies.
+        bool EmitNativeSet(Assembler &as, Scope &scope, size_t index, const Handlers &handlers)
+        {
+            Instruction &inst = scope.instructions[index];
+            if (inst.type != Token::KEYW_SET || inst.args.size() < 4 || inst.args[1].content == Registers::RET_VAL_NAME)
+                return false;
+
+            Token::Token &value = inst.args[3];
+            std::vector<VALUE_TYPE> types{};
+            NameCache *copied = nullptr;
+            Variant constant = NIL_VALUE;
+
+            if (inst.expr.size() == 1 && inst.expr[0].code == OPCODE::PUSH_NAME)
+                copied = &inst.expr[0].name.cache;
+            else if (inst.expr.size() == 1 && inst.expr[0].code == OPCODE::PUSH_CONST)
+                constant = inst.expr[0].value;
+            else if (inst.expr.size())
+            {
+                if (!PlanExpression(inst.expr, types))
+                    return false;
+            }
+            else if (value.type == Token::NAME)
+                copied = &value.cache;
+            else if (value.type != Token::NUMBER || MakeVariant(constant, value))
+                return false;
+
+            if (!copied && types.empty() && NativeConstType(constant) == VALUE_TYPE::NIL)
+                return false;
+
+            EmitNativeEntry(as, handlers, index);
+            if (copied)
+            {
+                EmitLoadName(as, *copied, scope, index);
+                EmitCheckNumber(as, index);
+            }
+            else if (types.empty())
+            {
+                EmitMovImm64(as, RAX, constant.bits);
+            }
+            else
+            {
+                EmitExpression(as, inst, types, scope, index);
+                EmitBoxResult(as, types.back());
+            }
+
+            EmitCachedSlot(as, inst.args[1].cache, scope, index);
+            Emit(as, {0x48, 0x89, 0x01}); // mov [rcx], rax
+            EmitNativeFallback(as, handlers, index);
+            return true;
+        }
+
+        // Condition of if/elif/while computed to an int, jumps to 'target' when it is 0.
+        bool EmitNativeCondition(Assembler &as, Scope &scope, size_t index, const Handlers &handlers, TARGET target, size_t target_index)
+        {
+            Instruction &inst = scope.instructions[index];
+            std::vector<VALUE_TYPE> types{};
+            if (!inst.expr.size() || !PlanExpression(inst.expr, types) || types.back() != VALUE_TYPE::INT)
+                return false;
+
+            EmitNativeEntry(as, handlers, index);
+            EmitExpression(as, inst, types, scope, index);
+            Emit(as, {0x48, 0x85, 0xC0}); // test rax, rax
+            EmitJumpIf(as, 0x84, target, target_index);
+            EmitNativeFallback(as, handlers, index);
+            return true;
+        }
+    }
+
+    Error Compile(Scope &scope, Scope &global_scope, const Handlers &handlers)
+    {
+        std::vector<Instruction> &insts = scope.instructions;
+        size_t count = insts.size();
+
+        if (count > UINT32_MAX)
+        {
+            Logger::Warning("JIT: scope is too large to compile:", {scope.name});
+            return Error::REJECTED;
+        }
+
+        Assembler as{};
+        std::vector<size_t> labels(count + 1, 0);
+        // Second entry of elif, reached by a false condition instead of the end of a branch.
+        std::vector<size_t> entries(count + 1, 0);
+        std::vector<size_t> builtin_sites{};
+
+        as.fallbacks.assign(count, 0);
+
+        // rbx holds the frame and r12 the stack pointer of a native template, rsp stays 16 byte aligned for calls.
+        Emit(as, {0x53});                   // push rbx
+        Emit(as, {0x41, 0x54});             // push r12
+        Emit(as, {0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8
+        Emit(as, {0x48, 0x89, 0xFB});       // mov rbx, rdi
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Instruction &inst = insts[i];
+            labels[i] = as.code.size();
+            entries[i] = as.code.size();
+
+            switch (inst.type)
+            {
+            case Token::KEYW_IF:
+                if (!EmitNativeCondition(as, scope, i, handlers, FalseTarget(insts, inst.jump), FalseTargetIndex(insts, inst.jump)))
+                    EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.step), i);
+                EmitFalseBranch(as, insts, inst.jump);
+                break;
+            case Token::KEYW_ELIF:
+                EmitJump(as, TARGET::LABEL, inst.exit);
+                entries[i] = as.code.size();
+                if (!EmitNativeCondition(as, scope, i, handlers, FalseTarget(insts, inst.jump), FalseTargetIndex(insts, inst.jump)))
+                    EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.step), i);
+                EmitFalseBranch(as, insts, inst.jump);
+                break;
+            case Token::KEYW_ELSE:
+                EmitJump(as, TARGET::LABEL, inst.exit);
+                break;
+            case Token::KEYW_ENDIF:
+                break;
+            case Token::KEYW_WHILE:
+                if (!EmitNativeCondition(as, scope, i, handlers, TARGET::LABEL, inst.exit))
+                    EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.step), i);
+                EmitBranchOnResult(as, TARGET::LABEL, inst.exit);
+                break;
+            case Token::KEYW_ENDWHILE:
+            case Token::KEYW_CONTINUE:
+                EmitJump(as, TARGET::LABEL, inst.jump);
+                break;
+            case Token::KEYW_BREAK:
+                EmitJump(as, TARGET::LABEL, inst.exit);
+                break;
+            case Token::KEYW_FOR:
+                EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.for_init), i);
+                EmitBranchOnResult(as, TARGET::LABEL, inst.exit);
+                break;
+            case Token::KEYW_ENDFOR:
+                EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.for_step), i);
+                EmitBranchOnResult(as, TARGET::LABEL, inst.jump + 1);
+                break;
+            default:
+                if (IsBuiltinCallSite(inst, scope, global_scope))
+                {
+                    BuiltinFuncs::BuiltinFunc func = BuiltinFuncs::FindBuiltIn(inst.args.at(1).content);
+                    EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.builtin), i,
+                                    reinterpret_cast<const void *>(func));
+                    builtin_sites.push_back(i);
+                }
+                else if (!EmitNativeSet(as, scope, i, handlers))
+                {
+                    EmitHandlerCall(as, reinterpret_cast<const void *>(handlers.step), i);
+                }
+                EmitStopOnResult(as);
+                break;
+            }
+        }
+
+        labels[count] = as.code.size();
+        entries[count] = as.code.size();
+        size_t exit = as.code.size();
+        Emit(as, {0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+        Emit(as, {0x41, 0x5C});             // pop r12
+        Emit(as, {0x5B});                   // pop rbx
+        Emit(as, {0xC3});                   // ret
+
+        for (const Fixup &fixup : as.fixups)
+        {
+            size_t target = exit;
+            if (fixup.target == TARGET::LABEL)
+                target = labels.at(fixup.index);
+            else if (fixup.target == TARGET::ENTRY)
+                target = entries.at(fixup.index);
+            else if (fixup.target == TARGET::FALLBACK)
+                target = as.fallbacks.at(fixup.index);
+
+            int32_t rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(fixup.at + 4));
+            std::memcpy(&as.code[fixup.at], &rel, sizeof(rel));
+        }
+
+        // Written while writable, then switched to executable so the buffer is never both.
+        void *mem = mmap(nullptr, as.code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+        {
+            Logger::Warning("JIT: could not map code buffer for", {scope.name});
+            return Error::REJECTED;
+        }
+        std::memcpy(mem, as.code.data(), as.code.size());
+        if (mprotect(mem, as.code.size(), PROT_READ | PROT_EXEC) != 0)
+        {
+            munmap(mem, as.code.size());
+            Logger::Warning("JIT: could not make code buffer executable for", {scope.name});
+            return Error::REJECTED;
+        }
+
+        scope.jit.entry = mem;
+        scope.jit.version = Global::scope_tree_version;
+        scope.jit.builtin_sites = builtin_sites;
+        LOG_DEBUG("JIT: compiled", {scope.name, std::to_string(as.code.size()), "bytes"});
+        return Error::OK;
+    }
+#else
+    Error Compile(Scope &scope, [[maybe_unused]] Scope &global_scope, [[maybe_unused]] const Handlers &handlers)
+    {
+        scope.jit.disabled = true;
+        return Error::REJECTED;
+    }
+#endif
+
+    // Runs the compiled code of a scope, returns the error which stopped it.
+    Error Run(Scope &scope, Scope &global_scope, LoopCounter *loop_regs)
+    {
+        Frame frame{
+            .scope = &scope,
+            .global_scope = &global_scope,
+            .loop_regs = loop_regs,
+            .error = Error::OK,
+            .exception = nullptr,
+        };
+        reinterpret_cast<EntryPoint>(scope.jit.entry)(&frame);
+        // Both modes report an exception the same way, through the handlers of the interpreter.
+        if (frame.exception)
+            std::rethrow_exception(frame.exception);
+        return frame.error;
+    }
+}
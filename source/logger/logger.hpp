@@ -2,16 +2,67 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <string>
 
 #include "../types/array.hpp"
 #include "../assert/runtime_assert.hpp"
+#include "../output/output.hpp"
+
+enum class LOG_LEVEL : uint8_t
+{
+    DEBUG = 0,
+    INFO = 1,
+    WARNING = 2,
+    ERROR = 3,
+    NONE = 4,
+};
+
+// Lowest level compiled in, LOG_* calls below it are dropped with their arguments.
+#ifndef GVS_LOG_FLOOR
+#define GVS_LOG_FLOOR 0
+#endif
 
 namespace Logger
 {
+    // Lowest level printed at runtime, set with --log-level.
+#if GVS_RELEASE
+    LOG_LEVEL level = LOG_LEVEL::INFO;
+#else
+    LOG_LEVEL level = LOG_LEVEL::DEBUG;
+#endif
+
+    constexpr bool IsCompiledIn(LOG_LEVEL lvl)
+    {
+        return lvl >= static_cast<LOG_LEVEL>(GVS_LOG_FLOOR);
+    }
+
+    bool IsEnabled(LOG_LEVEL lvl)
+    {
+        return IsCompiledIn(lvl) && lvl >= level;
+    }
+
+    bool ParseLevel(const std::string &name, LOG_LEVEL &out)
+    {
+        if (name == "debug")
+            out = LOG_LEVEL::DEBUG;
+        else if (name == "info")
+            out = LOG_LEVEL::INFO;
+        else if (name == "warning")
+            out = LOG_LEVEL::WARNING;
+        else if (name == "error")
+            out = LOG_LEVEL::ERROR;
+        else if (name == "none")
+            out = LOG_LEVEL::NONE;
+        else
+            return false;
+        return true;
+    }
+
     namespace
     {
         void PrintWithPrefix(const std::string &prefix, const std::string &arg0, const Array<std::string> &args)
         {
+            Output::Flush();
             std::cout << prefix << ": " << arg0;
             for (size_t i = 0; i < args.size; ++i)
             {
@@ -23,6 +74,7 @@ namespace Logger
 
     void Print(const std::string &arg0, const Array<std::string> &args)
     {
+        Output::Flush();
         std::cout << arg0;
         for (size_t i = 0; i < args.size; ++i)
         {
@@ -33,23 +85,42 @@ namespace Logger
 
     void Error(const std::string &arg0, const Array<std::string> &args)
     {
-        PrintWithPrefix("ERROR", arg0, args);
+        if (IsEnabled(LOG_LEVEL::ERROR))
+            PrintWithPrefix("ERROR", arg0, args);
     }
 
     void Warning(const std::string &arg0, const Array<std::string> &args)
     {
-        PrintWithPrefix("WARNING", arg0, args);
+        if (IsEnabled(LOG_LEVEL::WARNING))
+            PrintWithPrefix("WARNING", arg0, args);
     }
 
     void Info(const std::string &arg0, const Array<std::string> &args)
     {
-        PrintWithPrefix("INFO", arg0, args);
+        if (IsEnabled(LOG_LEVEL::INFO))
+            PrintWithPrefix("INFO", arg0, args);
     }
 
-    void Debug([[maybe_unused]] const std::string &arg0, [[maybe_unused]] const Array<std::string> &args)
+    void Debug(const std::string &arg0, const Array<std::string> &args)
     {
-#if !GVS_RELEASE
-        PrintWithPrefix("DEBUG", arg0, args);
-#endif
+        if (IsEnabled(LOG_LEVEL::DEBUG))
+            PrintWithPrefix("DEBUG", arg0, args);
     }
-};
\ No newline at end of file
+};
+
+// Arguments are only evaluated when the level is compiled in and enabled at runtime,
+// prefer these over calling Logger functions directly on hot paths.
+#define GVS_LOG(lvl, func, ...)                    \
+    do                                             \
+    {                                              \
+        if constexpr (Logger::IsCompiledIn(lvl))   \
+        {                                          \
+            if (Logger::IsEnabled(lvl))            \
+                func(__VA_ARGS__);                 \
+        }                                          \
+    } while (0)
+
+#define LOG_DEBUG(...) GVS_LOG(LOG_LEVEL::DEBUG, Logger::Debug, __VA_ARGS__)
+#define LOG_INFO(...) GVS_LOG(LOG_LEVEL::INFO, Logger::Info, __VA_ARGS__)
+#define LOG_WARNING(...) GVS_LOG(LOG_LEVEL::WARNING, Logger::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) GVS_LOG(LOG_LEVEL::ERROR, Logger::Error, __VA_ARGS__)
@@ -1,25 +1,74 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstring>
+#include <string_view>
 
 #include "../logger/logger.hpp"
 
 #include "../types/variant.hpp"
 #include "../memory/memory.hpp"
 
-std::string VarGetString(const Variant &v)
+// Whether the payload of 'v' is its own slot in Memory::strings.
+bool VarIsStoredString(const Variant &v)
 {
-    return Memory::strings.at(v.d64);
+    return !Packed::IsDouble(v) && Packed::TagOf(v) == Packed::TAG::STRING;
+}
+
+// Strings whose characters live in the payload, the frame arena or a slice of another string.
+bool VarIsInlineString(const Variant &v)
+{
+    return !Packed::IsDouble(v) && Packed::TagOf(v) == Packed::TAG::SHORT_STRING;
+}
+
+bool VarIsTempString(const Variant &v)
+{
+    return !Packed::IsDouble(v) && Packed::TagOf(v) == Packed::TAG::OBJECT &&
+           Packed::ObjectKindOf(v) == Packed::OBJECT_KIND::TEMP_STRING;
+}
+
+bool VarIsSliceString(const Variant &v)
+{
+    return !Packed::IsDouble(v) && Packed::TagOf(v) == Packed::TAG::OBJECT &&
+           Packed::ObjectKindOf(v) == Packed::OBJECT_KIND::STRING_SLICE;
+}
+
+const StringSlice &VarGetSlice(const Variant &v)
+{
+    return Memory::slices[VarGetHandle(v)];
+}
+
+// Characters of a string, inline, in the frame arena, a slice or in Memory::strings.
+// An inline view points into 'v', so it is only valid while 'v' is.
+std::string_view VarGetString(const Variant &v)
+{
+    switch (Packed::TagOf(v))
+    {
+    case Packed::TAG::SHORT_STRING:
+        // Little endian, the characters are the low bytes of the payload.
+        return std::string_view(reinterpret_cast<const char *>(&v.bits),
+                                static_cast<size_t>((Packed::PayloadOf(v) >> Packed::SHORT_STRING_LEN_SHIFT) & 0xFF));
+    case Packed::TAG::OBJECT:
+        if (VarIsTempString(v))
+            return Memory::TempString(Packed::ObjectSlotOf(v));
+        {
+            const StringSlice &slice = VarGetSlice(v);
+            return std::string_view(Memory::strings[slice.parent]).substr(slice.offset, slice.size);
+        }
+    default:
+        return Memory::strings.at(Packed::PayloadOf(v));
+    }
 }
 
 VarInt VarGetInt(const Variant &v)
 {
-    return std::bit_cast<int64_t>(v.d64);
+    if (Packed::TagOf(v) == Packed::TAG::INT)
+        return Packed::Int48Of(v);
+    return Memory::boxed_ints.at(Packed::PayloadOf(v));
 }
 
 VarFloat VarGetFloat(const Variant &v)
 {
-    return std::bit_cast<double>(v.d64);
+    return std::bit_cast<double>(v.bits);
 }
 
 VarNull VarGetNull()
@@ -27,13 +76,30 @@ VarNull VarGetNull()
     return 0LL;
 }
 
-std::vector<Variant> VarGetArray(const Variant &v)
+const VarArray &VarGetArray(const Variant &v)
+{
+    return Memory::arrays.at(VarGetHandle(v));
+}
+
+const TypedArray &VarGetTypedArray(const Variant &v)
+{
+    return Memory::typed_arrays.at(VarGetHandle(v));
+}
+
+// Size of an array or typed array.
+size_t VarArraySize(const Variant &v)
+{
+    if (VarType(v) == VALUE_TYPE::TYPED_ARRAY)
+        return VarGetTypedArray(v).size();
+    return VarGetArray(v).size();
+}
+
+const StructInstance &VarGetStruct(const Variant &v)
 {
-    return Memory::arrays.at(v.d64);
+    return Memory::structs.at(VarGetHandle(v));
 }
 
-std::unordered_map<std::string, Variant> VarGetMap()
+const VarMap &VarGetMap(const Variant &v)
 {
-    Logger::Error("VarGetMap is not defined yet.", {});
-    return {};
-}
\ No newline at end of file
+    return Memory::maps.at(VarGetHandle(v));
+}
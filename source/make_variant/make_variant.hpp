@@ -1,51 +1,143 @@
 #pragma once
 
 #include <iostream>
+#include <cstring>
 #include <string>
 
 #include "../types/token.hpp"
 #include "../types/variant.hpp"
 #include "../memory/memory.hpp"
+#include "get_variant.hpp"
 
 #include "../logger/logger.hpp"
 #include "../helper/helper.hpp"
 
-Error MakeVariant(Variant &var, Token::Token &val, bool make_const = false)
+Variant VarMakeInt(VarInt i)
 {
-    var.flags.is_const = make_const;
+    if (Packed::FitsInt48(i))
+        return Packed::FromInt48(i);
+    return Packed::Box(Packed::TAG::BOXED_INT, Memory::AllocBoxedInt(i));
+}
+
+Variant VarMakeFloat(VarFloat f)
+{
+    return Packed::FromDouble(f);
+}
+
+// Puts 's' in the payload when it fits, otherwise in the frame arena when the running instruction
+// allows it. False when it has to go to Memory::strings.
+bool VarMakeUnstoredString(std::string_view s, Variant &v)
+{
+    if (s.size() <= INLINE_STRING_CAPACITY)
+    {
+        uint64_t payload = static_cast<uint64_t>(s.size()) << Packed::SHORT_STRING_LEN_SHIFT;
+        std::memcpy(&payload, s.data(), s.size());
+        v = Packed::Box(Packed::TAG::SHORT_STRING, payload);
+        return true;
+    }
+
+    uint64_t handle = 0;
+    if (Memory::AllocTemp(s, handle))
+    {
+        v = Packed::BoxObject(Packed::OBJECT_KIND::TEMP_STRING, handle);
+        return true;
+    }
+    return false;
+}
+
+// Makes a string value, inline when it fits the payload, otherwise in the frame arena when the
+// running instruction allows it or stored in Memory::strings.
+Variant VarMakeString(std::string s)
+{
+    Variant v{};
+    if (!VarMakeUnstoredString(s, v))
+        v = Packed::Box(Packed::TAG::STRING, Memory::AllocString(std::move(s)));
+    return v;
+}
+
+// Like VarMakeString for characters owned elsewhere, they are only copied to a std::string when stored.
+Variant VarCopyString(std::string_view s)
+{
+    Variant v{};
+    if (!VarMakeUnstoredString(s, v))
+        v = Packed::Box(Packed::TAG::STRING, Memory::AllocString(std::string(s)));
+    return v;
+}
+
+// Value referring to 'slot' of the store of 'type', a string, array, map, typed array or struct.
+Variant VarMakeHandle(VALUE_TYPE type, uint64_t slot)
+{
+    switch (type)
+    {
+    case VALUE_TYPE::STRING:
+        return Packed::Box(Packed::TAG::STRING, slot);
+    case VALUE_TYPE::ARRAY:
+        return Packed::Box(Packed::TAG::ARRAY, slot);
+    case VALUE_TYPE::MAP:
+        return Packed::Box(Packed::TAG::MAP, slot);
+    case VALUE_TYPE::TYPED_ARRAY:
+        return Packed::BoxObject(Packed::OBJECT_KIND::TYPED_ARRAY, slot);
+    case VALUE_TYPE::STRUCT:
+        return Packed::BoxObject(Packed::OBJECT_KIND::STRUCT, slot);
+    default:
+        return NIL_VALUE;
+    }
+}
 
+// String viewing part of a stored string, see StringSlice.
+Variant VarMakeSlice(StringSlice s)
+{
+    return Packed::BoxObject(Packed::OBJECT_KIND::STRING_SLICE, Memory::AllocSlice(s));
+}
+
+// Moves a string out of the frame arena into the store, before it is written where it outlives the frame.
+void VarPromote(Variant &v)
+{
+    if (VarIsTempString(v))
+        v = Packed::Box(Packed::TAG::STRING, Memory::AllocString(std::string(VarGetString(v))));
+}
+
+// 'v' ready to be stored in an element, which may outlive the frame arena.
+Variant VarPromoted(Variant v)
+{
+    VarPromote(v);
+    return v;
+}
+
+Error MakeVariant(Variant &var, Token::Token &val)
+{
     switch (val.type)
     {
     case Token::STRING:
-    {
-        var.d64 = Memory::strings.size();
-        Memory::strings.push_back(val.content);
-        var.type = VALUE_TYPE::STRING;
+        var = VarCopyString(val.content);
         return Error::OK;
-    }
     case Token::NUMBER:
-    {
-        bool is_float = Helper::StringContains(val.content, '.');
-        var.d64 = is_float
-                      ? std::bit_cast<uint64_t>(std::stod(val.content))
-                      : std::bit_cast<uint64_t>(std::stoll(val.content));
-        var.type = is_float
-                       ? VALUE_TYPE::FLOAT
-                       : VALUE_TYPE::INT;
+        if (Helper::StringContains(val.content, '.'))
+            var = VarMakeFloat(std::stod(val.content));
+        else
+            var = VarMakeInt(std::stoll(val.content));
         return Error::OK;
-    }
     default:
-        var.d64 = 0;
-        var.type = VALUE_TYPE::NIL;
+        var = NIL_VALUE;
         return Error::REJECTED;
     }
 }
 
-Error MakeVarArray(Variant &var, std::vector<Token::Token> &values)
+// Element 'i' of an array or typed array, which must be in bounds.
+Variant VarArrayAt(const Variant &v, size_t i)
 {
-    var.type = VALUE_TYPE::ARRAY;
-    var.flags = {};
+    if (VarType(v) == VALUE_TYPE::TYPED_ARRAY)
+    {
+        const TypedArray &a = VarGetTypedArray(v);
+        if (a.elem == ELEM_TYPE::INT)
+            return VarMakeInt(a.ints.at(i));
+        return VarMakeFloat(a.floats.at(i));
+    }
+    return VarGetArray(v).at(i);
+}
 
+Error MakeVarArray(Variant &var, std::vector<Token::Token> &values)
+{
     VarArray result{};
 
     for (Token::Token &val : values)
@@ -54,10 +146,89 @@ Error MakeVarArray(Variant &var, std::vector<Token::Token> &values)
         Error make_err = MakeVariant(v, val);
         if (make_err)
             return Error::REJECTED;
-        result.push_back(v);
+        result.push_back(VarPromoted(v));
     }
 
-    var.d64 = Memory::arrays.size();
-    Memory::arrays.push_back(result);
+    var = VarMakeHandle(VALUE_TYPE::ARRAY, Memory::AllocArray(std::move(result)));
     return Error::OK;
-}
\ No newline at end of file
+}
+
+// Array of 'v' ready to be written, copied first when its handle is shared.
+// 'v' then holds the handle of the copy. The reference is invalidated by the next array allocation.
+VarArray &VarMutableArray(Variant &v)
+{
+    if (Memory::array_shared.at(VarGetHandle(v)))
+    {
+        VarArray copy = VarGetArray(v);
+        v = VarMakeHandle(VALUE_TYPE::ARRAY, Memory::AllocArray(std::move(copy)));
+    }
+    return Memory::arrays.at(VarGetHandle(v));
+}
+
+
+TypedArray &VarMutableTypedArray(Variant &v)
+{
+    if (Memory::typed_array_shared.at(VarGetHandle(v)))
+    {
+        TypedArray copy = VarGetTypedArray(v);
+        v = VarMakeHandle(VALUE_TYPE::TYPED_ARRAY, Memory::AllocTypedArray(std::move(copy)));
+    }
+    return Memory::typed_arrays.at(VarGetHandle(v));
+}
+
+VarMap &VarMutableMap(Variant &v)
+{
+    if (Memory::map_shared.at(VarGetHandle(v)))
+    {
+        VarMap copy = VarGetMap(v);
+        v = VarMakeHandle(VALUE_TYPE::MAP, Memory::AllocMap(std::move(copy)));
+    }
+    return Memory::maps.at(VarGetHandle(v));
+}
+
+// Canonical map key of an int or string, equal values get equal bits.
+// Ints within 48 bits and strings which fit the payload are their own key. Longer strings and
+// boxed ints are interned, when 'insert' is false a value never interned is rejected, as no map can hold it.
+bool VarMapKey(const Variant &v, bool insert, uint64_t &key)
+{
+    uint64_t slot = 0;
+    if (VarType(v) == VALUE_TYPE::INT)
+    {
+        if (Packed::TagOf(v) == Packed::TAG::INT)
+        {
+            key = v.bits;
+            return true;
+        }
+        if (!Memory::InternInt(VarGetInt(v), insert, slot))
+            return false;
+        key = Packed::Box(Packed::TAG::BOXED_INT, slot).bits;
+        return true;
+    }
+
+    if (VarType(v) != VALUE_TYPE::STRING)
+        return false;
+
+    std::string_view s = VarGetString(v);
+    if (s.size() <= INLINE_STRING_CAPACITY)
+    {
+        key = VarCopyString(s).bits;
+        return true;
+    }
+    bool stored = VarIsStoredString(v);
+    if (stored && Memory::IsInternedString(VarGetHandle(v)))
+        slot = VarGetHandle(v);
+    else if (!Memory::InternString(s, insert, slot, stored ? VarGetHandle(v) : Memory::NO_SLOT))
+        return false;
+    key = Packed::Box(Packed::TAG::STRING, slot).bits;
+    return true;
+}
+
+StructInstance &VarMutableStruct(Variant &v)
+{
+    if (Memory::struct_shared.at(VarGetHandle(v)))
+    {
+        StructInstance copy = VarGetStruct(v);
+        v = VarMakeHandle(VALUE_TYPE::STRUCT, Memory::AllocStruct(std::move(copy)));
+    }
+    return Memory::structs.at(VarGetHandle(v));
+}
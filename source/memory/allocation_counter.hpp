@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+
+#if _WIN32
+#include <malloc.h>
+#endif
+
+// Test builds count heap allocations, release builds keep the standard allocation functions.
+// Build with -DGVS_COUNT_ALLOCATIONS=1 to run alloc_tests.gvs.
+#ifndef GVS_COUNT_ALLOCATIONS
+#define GVS_COUNT_ALLOCATIONS 0
+#endif
+
+#if GVS_COUNT_ALLOCATIONS
+namespace Memory
+{
+    // Number of heap allocations made through operator new since startup.
+    uint64_t heap_allocations = 0;
+
+    void *CountedAlloc(std::size_t size) noexcept
+    {
+        ++heap_allocations;
+        return std::malloc(size ? size : 1);
+    }
+
+    void *CountedAlignedAlloc(std::size_t size, std::align_val_t align) noexcept
+    {
+        ++heap_allocations;
+        std::size_t a = static_cast<std::size_t>(align);
+#if _WIN32
+        return _aligned_malloc(size ? size : 1, a);
+#else
+        // aligned_alloc wants a size which is a multiple of the alignment.
+        return std::aligned_alloc(a, size ? (size + a - 1) / a * a : a);
+#endif
+    }
+
+    // Kept out of line so compilers don't pair the inlined free() with operator new.
+    [[gnu::noinline]] void FreeAllocation(void *ptr) noexcept
+    {
+        std::free(ptr);
+    }
+
+    [[gnu::noinline]] void FreeAlignedAllocation(void *ptr) noexcept
+    {
+#if _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+// Replaces the global allocation functions to count allocations, which
+// lets scripts check that hot paths such as calls do not allocate.
+// The array forms forward to these by default.
+void *operator new(std::size_t size)
+{
+    if (void *ptr = Memory::CountedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return Memory::CountedAlloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    if (void *ptr = Memory::CountedAlignedAlloc(size, align))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    return Memory::CountedAlignedAlloc(size, align);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    Memory::FreeAllocation(ptr);
+}
+
+void operator delete(void *ptr, [[maybe_unused]] std::size_t size) noexcept
+{
+    Memory::FreeAllocation(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    Memory::FreeAllocation(ptr);
+}
+
+void operator delete(void *ptr, [[maybe_unused]] std::align_val_t align) noexcept
+{
+    Memory::FreeAlignedAllocation(ptr);
+}
+
+void operator delete(void *ptr, [[maybe_unused]] std::size_t size, [[maybe_unused]] std::align_val_t align) noexcept
+{
+    Memory::FreeAlignedAllocation(ptr);
+}
+
+void operator delete(void *ptr, [[maybe_unused]] std::align_val_t align, const std::nothrow_t &) noexcept
+{
+    Memory::FreeAlignedAllocation(ptr);
+}
+#endif
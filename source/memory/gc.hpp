@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../types/variant.hpp"
+#include "../types/scope.hpp"
+#include "../registers/registers.hpp"
+#include "memory.hpp"
+
+// Mark-and-sweep collector for Memory::strings, the array stores, Memory::maps, Memory::structs,
+// Memory::slices and Memory::boxed_ints.
+// Collections only run at safepoints, the start of an instruction, where every live
+// value is held by a scope, an instruction operand or a register. Freed slots go on
+// the free lists of the stores so the indices held by live values never move.
+namespace Gc
+{
+    // Allocations between collections, raised to twice the surviving entries when more survive.
+    const uint64_t DEFAULT_THRESHOLD = 10000;
+
+    struct Counters
+    {
+        uint64_t collections = 0;
+        uint64_t freed_strings = 0;
+        uint64_t freed_arrays = 0;
+        uint64_t freed_maps = 0;
+        uint64_t freed_structs = 0;
+        uint64_t freed_slices = 0;
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+    };
+
+    bool enabled = true;
+    uint64_t threshold = DEFAULT_THRESHOLD;
+    Counters counters{};
+
+    // Outermost scope of the running program, imported files hang below it.
+    Scope *root = nullptr;
+
+    namespace
+    {
+        std::vector<uint8_t> string_marks = {};
+        std::vector<uint8_t> array_marks = {};
+        std::vector<uint8_t> boxed_int_marks = {};
+        std::vector<uint8_t> typed_array_marks = {};
+        std::vector<uint8_t> map_marks = {};
+        std::vector<uint8_t> struct_marks = {};
+        std::vector<uint8_t> slice_marks = {};
+        // Arrays, maps and structs marked but whose elements were not visited yet.
+        std::vector<uint64_t> pending_arrays = {};
+        std::vector<uint64_t> pending_maps = {};
+        std::vector<uint64_t> pending_structs = {};
+
+        void MarkValue(Variant v)
+        {
+            if (Packed::IsDouble(v))
+                return;
+
+            uint64_t slot = VarGetHandle(v);
+            switch (Packed::TagOf(v))
+            {
+            case Packed::TAG::STRING:
+                if (slot < string_marks.size())
+                    string_marks[slot] = 1;
+                break;
+            case Packed::TAG::BOXED_INT:
+                if (slot < boxed_int_marks.size())
+                    boxed_int_marks[slot] = 1;
+                break;
+            case Packed::TAG::ARRAY:
+                if (slot < array_marks.size() && !array_marks[slot])
+                {
+                    array_marks[slot] = 1;
+                    pending_arrays.push_back(slot);
+                }
+                break;
+            case Packed::TAG::MAP:
+                if (slot < map_marks.size() && !map_marks[slot])
+                {
+                    map_marks[slot] = 1;
+                    pending_maps.push_back(slot);
+                }
+                break;
+            case Packed::TAG::OBJECT:
+                switch (Packed::ObjectKindOf(v))
+                {
+                case Packed::OBJECT_KIND::STRING_SLICE:
+                    if (slot < slice_marks.size())
+                    {
+                        // A slice keeps its parent alive.
+                        slice_marks[slot] = 1;
+                        string_marks[Memory::slices[slot].parent] = 1;
+                    }
+                    break;
+                case Packed::OBJECT_KIND::TYPED_ARRAY:
+                    if (slot < typed_array_marks.size())
+                        typed_array_marks[slot] = 1;
+                    break;
+                case Packed::OBJECT_KIND::STRUCT:
+                    if (slot < struct_marks.size() && !struct_marks[slot])
+                    {
+                        struct_marks[slot] = 1;
+                        pending_structs.push_back(slot);
+                    }
+                    break;
+                default:
+                    break;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        void MarkScope(const Scope &scope)
+        {
+            for (const auto &[name, value] : scope.args)
+                MarkValue(value);
+            for (const auto &[name, value] : scope.vars)
+                MarkValue(value);
+
+            for (const Instruction &inst : scope.instructions)
+            {
+                for (const Variant &value : inst.call_args)
+                    MarkValue(value);
+                for (const ExprOp &op : inst.expr)
+                {
+                    if (op.code == OPCODE::PUSH_CONST)
+                        MarkValue(op.value);
+                }
+            }
+
+            for (const auto &[name, child] : scope.scopes)
+                MarkScope(child);
+        }
+
+        void MarkRoots()
+        {
+            MarkScope(*root);
+            for (const Shape &shape : Shapes::shapes)
+            {
+                for (Variant value : shape.defaults)
+                    MarkValue(value);
+            }
+            MarkValue(Registers::ret_val);
+            for (size_t i = 0; i < Registers::arg_top; ++i)
+                MarkValue(Registers::arg_stack[i]);
+
+            while (pending_arrays.size() || pending_maps.size() || pending_structs.size())
+            {
+                if (pending_arrays.size())
+                {
+                    uint64_t slot = pending_arrays.back();
+                    pending_arrays.pop_back();
+                    for (Variant value : Memory::arrays[slot])
+                        MarkValue(value);
+                    continue;
+                }
+                if (pending_structs.size())
+                {
+                    uint64_t slot = pending_structs.back();
+                    pending_structs.pop_back();
+                    for (Variant value : Memory::structs[slot].fields)
+                        MarkValue(value);
+                    continue;
+                }
+
+                uint64_t slot = pending_maps.back();
+                pending_maps.pop_back();
+                Memory::maps[slot].ForEach([](const VarMap::Slot &entry)
+                                           {
+                                               MarkValue(Variant{entry.key});
+                                               MarkValue(entry.value); });
+            }
+        }
+
+        void Sweep()
+        {
+            for (uint64_t slot = 0; slot < string_marks.size(); ++slot)
+            {
+                if (!string_marks[slot])
+                {
+                    Memory::FreeString(slot);
+                    ++counters.freed_strings;
+                }
+            }
+            for (uint64_t slot = 0; slot < array_marks.size(); ++slot)
+            {
+                if (!array_marks[slot])
+                {
+                    Memory::FreeArray(slot);
+                    ++counters.freed_arrays;
+                }
+            }
+            for (uint64_t slot = 0; slot < map_marks.size(); ++slot)
+            {
+                if (!map_marks[slot])
+                {
+                    Memory::FreeMap(slot);
+                    ++counters.freed_maps;
+                }
+            }
+            for (uint64_t slot = 0; slot < struct_marks.size(); ++slot)
+            {
+                if (!struct_marks[slot])
+                {
+                    Memory::FreeStruct(slot);
+                    ++counters.freed_structs;
+                }
+            }
+            for (uint64_t slot = 0; slot < typed_array_marks.size(); ++slot)
+            {
+                if (!typed_array_marks[slot])
+                {
+                    Memory::FreeTypedArray(slot);
+                    ++counters.freed_arrays;
+                }
+            }
+            for (uint64_t slot = 0; slot < slice_marks.size(); ++slot)
+            {
+                if (!slice_marks[slot])
+                {
+                    Memory::FreeSlice(slot);
+                    ++counters.freed_slices;
+                }
+            }
+            for (uint64_t slot = 0; slot < boxed_int_marks.size(); ++slot)
+            {
+                if (!boxed_int_marks[slot])
+                    Memory::FreeBoxedInt(slot);
+            }
+        }
+    }
+
+    void Collect()
+    {
+        if (!root)
+            return;
+
+        auto start = std::chrono::steady_clock::now();
+
+        string_marks.assign(Memory::strings.size(), 0);
+        array_marks.assign(Memory::arrays.size(), 0);
+        boxed_int_marks.assign(Memory::boxed_ints.size(), 0);
+        typed_array_marks.assign(Memory::typed_arrays.size(), 0);
+        map_marks.assign(Memory::maps.size(), 0);
+        struct_marks.assign(Memory::structs.size(), 0);
+        slice_marks.assign(Memory::slices.size(), 0);
+        // Slots already free count as marked so they are not freed twice.
+        for (uint64_t slot : Memory::free_strings)
+            string_marks[slot] = 1;
+        for (uint64_t slot : Memory::free_arrays)
+            array_marks[slot] = 1;
+        for (uint64_t slot : Memory::free_boxed_ints)
+            boxed_int_marks[slot] = 1;
+        for (uint64_t slot : Memory::free_typed_arrays)
+            typed_array_marks[slot] = 1;
+        for (uint64_t slot : Memory::free_maps)
+            map_marks[slot] = 1;
+        for (uint64_t slot : Memory::free_structs)
+            struct_marks[slot] = 1;
+        for (uint64_t slot : Memory::free_slices)
+            slice_marks[slot] = 1;
+
+        MarkRoots();
+        Sweep();
+
+        Memory::allocations_since_gc = 0;
+        threshold = std::max(DEFAULT_THRESHOLD, 2 * (Memory::string_stats.live + Memory::array_stats.live + Memory::map_stats.live + Memory::struct_stats.live + Memory::slice_stats.live));
+
+        uint64_t pause = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                   std::chrono::steady_clock::now() - start)
+                                                   .count());
+        ++counters.collections;
+        counters.total_ns += pause;
+        counters.max_ns = std::max(counters.max_ns, pause);
+    }
+
+    // Called at the start of every instruction.
+    inline void Safepoint()
+    {
+        if (enabled && Memory::allocations_since_gc >= threshold)
+            Collect();
+    }
+
+    void Report(std::ostream &out)
+    {
+        double total_ms = static_cast<double>(counters.total_ns) / 1e6;
+        double max_ms = static_cast<double>(counters.max_ns) / 1e6;
+        double avg_ms = counters.collections ? total_ms / static_cast<double>(counters.collections) : 0.0;
+
+        out << "\nGarbage collector:\n"
+            << "  collections     " << counters.collections << "\n"
+            << "  freed strings   " << counters.freed_strings << "\n"
+            << "  freed arrays    " << counters.freed_arrays << "\n"
+            << "  freed maps      " << counters.freed_maps << "\n"
+            << "  freed structs   " << counters.freed_structs << "\n"
+            << "  freed slices    " << counters.freed_slices << "\n"
+            << std::fixed << std::setprecision(3)
+            << "  total pause ms  " << total_ms << "\n"
+            << "  avg pause ms    " << avg_ms << "\n"
+            << "  max pause ms    " << max_ms << "\n";
+    }
+}
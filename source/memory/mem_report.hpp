@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../types/token.hpp"
+#include "../types/scope.hpp"
+#include "memory.hpp"
+
+// String/array store usage printed at exit with --mem-report.
+namespace MemReport
+{
+    // Allocation sites listed, largest first.
+    const size_t TOP_SITES = 20;
+
+    namespace
+    {
+        std::string SiteLabel(const Memory::Site &site)
+        {
+            if (!site.first)
+                return "<parser>";
+
+            const Scope &scope = *site.first;
+            std::string label = QualifiedScopeName(scope);
+            if (site.second < scope.instructions.size() && scope.instructions[site.second].args.size())
+            {
+                const Token::Token &keyword = scope.instructions[site.second].args[0];
+                label += ":" + std::to_string(keyword.line) + " " + keyword.content;
+            }
+            return label;
+        }
+
+        void PrintStore(std::ostream &out, const std::string &name, const Memory::StoreStats &stats)
+        {
+            out << "  " << std::left << std::setw(10) << name << std::right
+                << std::setw(12) << stats.live << std::setw(14) << stats.bytes
+                << std::setw(12) << stats.peak_live << std::setw(14) << stats.peak_bytes << "\n";
+        }
+    }
+
+    // Must run while the scopes of the recorded sites are alive.
+    void Report(std::ostream &out)
+    {
+        out << "\nMemory stores:\n";
+        out << "  " << std::left << std::setw(10) << "store" << std::right
+            << std::setw(12) << "live" << std::setw(14) << "bytes"
+            << std::setw(12) << "peak live" << std::setw(14) << "peak bytes" << "\n";
+        PrintStore(out, "strings", Memory::string_stats);
+        PrintStore(out, "arrays", Memory::array_stats);
+        PrintStore(out, "maps", Memory::map_stats);
+        PrintStore(out, "structs", Memory::struct_stats);
+        PrintStore(out, "slices", Memory::slice_stats);
+        out << "  frame arena: " << Memory::temp_allocations << " temporary strings, peak "
+            << Memory::arena_peak_bytes << " bytes\n";
+
+        std::vector<std::pair<Memory::Site, Memory::SiteStats>> sites(Memory::sites.begin(), Memory::sites.end());
+        std::stable_sort(sites.begin(), sites.end(), [](const auto &a, const auto &b)
+                         { return a.second.bytes > b.second.bytes; });
+        if (sites.size() > TOP_SITES)
+            sites.resize(TOP_SITES);
+
+        out << "\nAllocation sites (sorted by bytes):\n";
+        out << "  " << std::left << std::setw(40) << "site" << std::right
+            << std::setw(10) << "strings" << std::setw(10) << "arrays" << std::setw(14) << "bytes" << "\n";
+        for (const auto &[site, stats] : sites)
+        {
+            out << "  " << std::left << std::setw(40) << SiteLabel(site) << std::right
+                << std::setw(10) << stats.strings << std::setw(10) << stats.arrays
+                << std::setw(14) << stats.bytes << "\n";
+        }
+    }
+}
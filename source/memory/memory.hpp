@@ -1,12 +1,521 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "../types/variant.hpp"
+#include "../types/call_frame.hpp"
+#include "../registers/registers.hpp"
 
 namespace Memory
 {
     std::vector<std::string> strings = {};
     std::vector<VarArray> arrays = {};
+    // Set once a second variable may hold the handle of an array, mutations copy it first.
+    // Never cleared while the entry lives, so a shared array is copied at most once per holder.
+    std::vector<uint8_t> array_shared = {};
+    // Homogeneous int/float arrays, shared the same way as the arrays.
+    std::vector<TypedArray> typed_arrays = {};
+    std::vector<uint8_t> typed_array_shared = {};
+    std::vector<VarMap> maps = {};
+    std::vector<uint8_t> map_shared = {};
+    std::vector<StructInstance> structs = {};
+    std::vector<uint8_t> struct_shared = {};
+    std::vector<StringSlice> slices = {};
+    // Ints which do not fit the 48 bit payload of a Variant.
+    std::vector<int64_t> boxed_ints = {};
+
+    // Hashes and compares a slot of Memory::strings by its characters, so a table of
+    // slots can be searched with a string_view without holding a copy of each string.
+    struct StringSlotHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+        size_t operator()(uint64_t slot) const
+        {
+            return std::hash<std::string_view>{}(strings[slot]);
+        }
+    };
+
+    struct StringSlotEqual
+    {
+        using is_transparent = void;
+        bool operator()(uint64_t a, uint64_t b) const
+        {
+            return a == b;
+        }
+        bool operator()(std::string_view s, uint64_t slot) const
+        {
+            return s == strings[slot];
+        }
+        bool operator()(uint64_t slot, std::string_view s) const
+        {
+            return strings[slot] == s;
+        }
+    };
+
+    // Map keys are interned so equal keys share a slot and compare by their bits.
+    // The tables are weak: the collector drops entries whose slot it frees.
+    // Interned strings are keyed on their slot, the characters stay in Memory::strings only.
+    std::unordered_set<uint64_t, StringSlotHash, StringSlotEqual> interned_strings = {};
+    std::unordered_map<int64_t, uint64_t> interned_ints = {};
+    std::vector<uint8_t> string_interned = {};
+    std::vector<uint8_t> boxed_int_interned = {};
+
+    // Accounting of one store, bytes include the vector slot and the heap buffer of the entry.
+    struct StoreStats
+    {
+        uint64_t allocations = 0;
+        uint64_t live = 0;
+        uint64_t bytes = 0;
+        uint64_t peak_live = 0;
+        uint64_t peak_bytes = 0;
+    };
+
+    struct SiteStats
+    {
+        uint64_t strings = 0;
+        uint64_t arrays = 0;
+        uint64_t bytes = 0;
+    };
+
+    // Scope and instruction index which allocated, a null scope for literals made by the parser.
+    using Site = std::pair<const Scope *, size_t>;
+
+    StoreStats string_stats{};
+    StoreStats array_stats{};
+    StoreStats map_stats{};
+    StoreStats struct_stats{};
+    StoreStats slice_stats{};
+
+    // Slots released by the collector, reused before the stores grow.
+    std::vector<uint64_t> free_strings = {};
+    std::vector<uint64_t> free_arrays = {};
+    std::vector<uint64_t> free_boxed_ints = {};
+    std::vector<uint64_t> free_typed_arrays = {};
+    std::vector<uint64_t> free_maps = {};
+    std::vector<uint64_t> free_structs = {};
+    std::vector<uint64_t> free_slices = {};
+
+    // Allocations since the last collection, the collector runs at the next safepoint once it passes the threshold.
+    uint64_t allocations_since_gc = 0;
+
+    // Bump arena for strings which stay in locals of the running function, see Compiler::MarkLocalTargets.
+    // Every frame resets it to where it was on entry, the strings still held by locals then move to the store.
+    const size_t ARENA_SIZE = 1 << 20;
+    const size_t NO_ARENA_FRAME = SIZE_MAX;
+    char arena[ARENA_SIZE];
+    size_t arena_top = 0;
+    // Frame depth whose instruction may put its result in the arena, only set while one runs.
+    size_t arena_frame = NO_ARENA_FRAME;
+    uint64_t temp_allocations = 0;
+    // A handle of the arena holds the offset below this bit and the size above, 43 bits in all,
+    // which fits the slot of a NaN-boxed object.
+    const uint64_t TEMP_SIZE_SHIFT = 22;
+    static_assert(ARENA_SIZE < (1ULL << TEMP_SIZE_SHIFT));
+    uint64_t arena_peak_bytes = 0;
+
+    // Per-site attribution costs a map lookup per allocation, only done for --mem-report.
+    bool track_sites = false;
+    std::map<Site, SiteStats> sites = {};
+
+    size_t StringBytes(const std::string &s)
+    {
+        // Strings within the small string buffer own no heap memory.
+        static const size_t inline_capacity = std::string{}.capacity();
+        return sizeof(std::string) + (s.capacity() > inline_capacity ? s.capacity() + 1 : 0);
+    }
+
+    size_t ArrayBytes(const VarArray &a)
+    {
+        return sizeof(VarArray) + a.capacity() * sizeof(VarArray::value_type);
+    }
+
+    size_t TypedArrayBytes(const TypedArray &a)
+    {
+        return sizeof(TypedArray) + a.capacity() * sizeof(uint64_t);
+    }
+
+    size_t MapBytes(const VarMap &m)
+    {
+        return sizeof(VarMap) + m.ctrl.capacity() + m.slots.capacity() * sizeof(VarMap::Slot);
+    }
+
+    size_t StructBytes(const StructInstance &s)
+    {
+        return sizeof(StructInstance) + s.fields.capacity() * sizeof(Variant);
+    }
+
+    namespace
+    {
+        void Account(StoreStats &stats, size_t bytes)
+        {
+            ++stats.allocations;
+            ++stats.live;
+            stats.bytes += bytes;
+            if (stats.live > stats.peak_live)
+                stats.peak_live = stats.live;
+            if (stats.bytes > stats.peak_bytes)
+                stats.peak_bytes = stats.bytes;
+        }
+
+        void Release(StoreStats &stats, size_t bytes)
+        {
+            --stats.live;
+            stats.bytes -= bytes;
+        }
+
+        SiteStats &CurrentSite()
+        {
+            size_t depth = Registers::frame_depth.load(std::memory_order_relaxed);
+            if (!depth)
+                return sites[Site{nullptr, 0}];
+
+            const CallFrame &frame = Registers::frames[depth - 1];
+            return sites[Site{frame.scope, frame.ip}];
+        }
+    }
+
+    // Stores a string and returns its index, every string entry is created here.
+    uint64_t AllocString(std::string s)
+    {
+        size_t bytes = StringBytes(s);
+        Account(string_stats, bytes);
+        if (track_sites)
+        {
+            SiteStats &site = CurrentSite();
+            ++site.strings;
+            site.bytes += bytes;
+        }
+
+        ++allocations_since_gc;
+        if (free_strings.size())
+        {
+            uint64_t slot = free_strings.back();
+            free_strings.pop_back();
+            strings[slot] = std::move(s);
+            return slot;
+        }
+        strings.push_back(std::move(s));
+        return strings.size() - 1;
+    }
+
+    // Stores an array and returns its index, every array entry is created here.
+    uint64_t AllocArray(VarArray a)
+    {
+        size_t bytes = ArrayBytes(a);
+        Account(array_stats, bytes);
+        if (track_sites)
+        {
+            SiteStats &site = CurrentSite();
+            ++site.arrays;
+            site.bytes += bytes;
+        }
+
+        ++allocations_since_gc;
+        if (free_arrays.size())
+        {
+            uint64_t slot = free_arrays.back();
+            free_arrays.pop_back();
+            arrays[slot] = std::move(a);
+            array_shared[slot] = 0;
+            return slot;
+        }
+        arrays.push_back(std::move(a));
+        array_shared.push_back(0);
+        return arrays.size() - 1;
+    }
+
+    // Typed arrays are accounted with the arrays.
+    uint64_t AllocTypedArray(TypedArray a)
+    {
+        size_t bytes = TypedArrayBytes(a);
+        Account(array_stats, bytes);
+        if (track_sites)
+        {
+            SiteStats &site = CurrentSite();
+            ++site.arrays;
+            site.bytes += bytes;
+        }
+
+        ++allocations_since_gc;
+        if (free_typed_arrays.size())
+        {
+            uint64_t slot = free_typed_arrays.back();
+            free_typed_arrays.pop_back();
+            typed_arrays[slot] = std::move(a);
+            typed_array_shared[slot] = 0;
+            return slot;
+        }
+        typed_arrays.push_back(std::move(a));
+        typed_array_shared.push_back(0);
+        return typed_arrays.size() - 1;
+    }
+
+    uint64_t AllocMap(VarMap m)
+    {
+        size_t bytes = MapBytes(m);
+        Account(map_stats, bytes);
+        if (track_sites)
+            CurrentSite().bytes += bytes;
+
+        ++allocations_since_gc;
+        if (free_maps.size())
+        {
+            uint64_t slot = free_maps.back();
+            free_maps.pop_back();
+            maps[slot] = std::move(m);
+            map_shared[slot] = 0;
+            return slot;
+        }
+        maps.push_back(std::move(m));
+        map_shared.push_back(0);
+        return maps.size() - 1;
+    }
+
+    uint64_t AllocSlice(StringSlice s)
+    {
+        Account(slice_stats, sizeof(StringSlice));
+        if (track_sites)
+            CurrentSite().bytes += sizeof(StringSlice);
+
+        ++allocations_since_gc;
+        if (free_slices.size())
+        {
+            uint64_t slot = free_slices.back();
+            free_slices.pop_back();
+            slices[slot] = s;
+            return slot;
+        }
+        slices.push_back(s);
+        return slices.size() - 1;
+    }
+
+    uint64_t AllocStruct(StructInstance s)
+    {
+        size_t bytes = StructBytes(s);
+        Account(struct_stats, bytes);
+        if (track_sites)
+            CurrentSite().bytes += bytes;
+
+        ++allocations_since_gc;
+        if (free_structs.size())
+        {
+            uint64_t slot = free_structs.back();
+            free_structs.pop_back();
+            structs[slot] = std::move(s);
+            struct_shared[slot] = 0;
+            return slot;
+        }
+        structs.push_back(std::move(s));
+        struct_shared.push_back(0);
+        return structs.size() - 1;
+    }
+
+    // Updates the accounting of a map whose table was rebuilt in place.
+    void ReaccountMap(size_t old_bytes, size_t new_bytes)
+    {
+        map_stats.bytes = map_stats.bytes - old_bytes + new_bytes;
+        if (map_stats.bytes > map_stats.peak_bytes)
+            map_stats.peak_bytes = map_stats.bytes;
+    }
+
+    // Updates the accounting of an array whose buffer was resized in place.
+    void ReaccountArray(size_t old_bytes, size_t new_bytes)
+    {
+        array_stats.bytes = array_stats.bytes - old_bytes + new_bytes;
+        if (array_stats.bytes > array_stats.peak_bytes)
+            array_stats.peak_bytes = array_stats.bytes;
+    }
+
+    void AppendToArray(uint64_t slot, Variant value)
+    {
+        VarArray &a = arrays.at(slot);
+        size_t old_bytes = ArrayBytes(a);
+        a.push_back(value);
+        ReaccountArray(old_bytes, ArrayBytes(a));
+    }
+
+    // Called when the handle in 'v' gets copied into another variable.
+    void ShareArray(const Variant &v)
+    {
+        uint64_t slot = VarGetHandle(v);
+        switch (VarType(v))
+        {
+        case VALUE_TYPE::ARRAY:
+            if (slot < array_shared.size())
+                array_shared[slot] = 1;
+            break;
+        case VALUE_TYPE::TYPED_ARRAY:
+            if (slot < typed_array_shared.size())
+                typed_array_shared[slot] = 1;
+            break;
+        case VALUE_TYPE::MAP:
+            if (slot < map_shared.size())
+                map_shared[slot] = 1;
+            break;
+        case VALUE_TYPE::STRUCT:
+            if (slot < struct_shared.size())
+                struct_shared[slot] = 1;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Copies 's' to the arena when the running frame may use it, the handle packs its length and offset.
+    bool AllocTemp(std::string_view s, uint64_t &handle)
+    {
+        if (arena_frame != Registers::frame_depth.load(std::memory_order_relaxed) || arena_top + s.size() > ARENA_SIZE)
+            return false;
+
+        std::memcpy(arena + arena_top, s.data(), s.size());
+        handle = (static_cast<uint64_t>(s.size()) << TEMP_SIZE_SHIFT) | arena_top;
+        arena_top += s.size();
+        ++temp_allocations;
+        if (arena_top > arena_peak_bytes)
+            arena_peak_bytes = arena_top;
+        return true;
+    }
+
+    std::string_view TempString(uint64_t handle)
+    {
+        return std::string_view(arena + (handle & ((1ULL << TEMP_SIZE_SHIFT) - 1)), handle >> TEMP_SIZE_SHIFT);
+    }
+
+    uint64_t AllocBoxedInt(int64_t i)
+    {
+        ++allocations_since_gc;
+        if (free_boxed_ints.size())
+        {
+            uint64_t slot = free_boxed_ints.back();
+            free_boxed_ints.pop_back();
+            boxed_ints[slot] = i;
+            return slot;
+        }
+        boxed_ints.push_back(i);
+        return boxed_ints.size() - 1;
+    }
+
+    const uint64_t NO_SLOT = UINT64_MAX;
+
+    // Slot of the interned copy of 's'. When there is none, 'insert' makes it, otherwise returns false.
+    // A stored string 's' passes its own slot as 'stored', which then becomes the interned copy.
+    bool InternString(std::string_view s, bool insert, uint64_t &slot, uint64_t stored = NO_SLOT)
+    {
+        auto it = interned_strings.find(s);
+        if (it != interned_strings.end())
+        {
+            slot = *it;
+            return true;
+        }
+        if (!insert)
+            return false;
+
+        slot = stored != NO_SLOT ? stored : AllocString(std::string(s));
+        if (string_interned.size() < strings.size())
+            string_interned.resize(strings.size());
+        string_interned[slot] = 1;
+        interned_strings.insert(slot);
+        return true;
+    }
+
+    bool IsInternedString(uint64_t slot)
+    {
+        return slot < string_interned.size() && string_interned[slot];
+    }
+
+    bool InternInt(int64_t i, bool insert, uint64_t &slot)
+    {
+        auto it = interned_ints.find(i);
+        if (it != interned_ints.end())
+        {
+            slot = it->second;
+            return true;
+        }
+        if (!insert)
+            return false;
+
+        slot = AllocBoxedInt(i);
+        if (boxed_int_interned.size() < boxed_ints.size())
+            boxed_int_interned.resize(boxed_ints.size());
+        boxed_int_interned[slot] = 1;
+        interned_ints.emplace(i, slot);
+        return true;
+    }
+
+    // Releases the buffer of an unreachable string and puts its slot on the free list.
+    void FreeString(uint64_t slot)
+    {
+        if (IsInternedString(slot))
+        {
+            // Before the characters go, the table hashes the slot by them.
+            interned_strings.erase(slot);
+            string_interned[slot] = 0;
+        }
+        Release(string_stats, StringBytes(strings[slot]));
+        std::string().swap(strings[slot]);
+        free_strings.push_back(slot);
+    }
+
+    void FreeArray(uint64_t slot)
+    {
+        Release(array_stats, ArrayBytes(arrays[slot]));
+        VarArray().swap(arrays[slot]);
+        array_shared[slot] = 0;
+        free_arrays.push_back(slot);
+    }
+
+    void FreeTypedArray(uint64_t slot)
+    {
+        Release(array_stats, TypedArrayBytes(typed_arrays[slot]));
+        typed_arrays[slot] = TypedArray{};
+        typed_array_shared[slot] = 0;
+        free_typed_arrays.push_back(slot);
+    }
+
+    void FreeMap(uint64_t slot)
+    {
+        Release(map_stats, MapBytes(maps[slot]));
+        maps[slot] = VarMap{};
+        map_shared[slot] = 0;
+        free_maps.push_back(slot);
+    }
+
+    void FreeSlice(uint64_t slot)
+    {
+        Release(slice_stats, sizeof(StringSlice));
+        slices[slot] = StringSlice{};
+        free_slices.push_back(slot);
+    }
+
+    void FreeStruct(uint64_t slot)
+    {
+        Release(struct_stats, StructBytes(structs[slot]));
+        structs[slot] = StructInstance{};
+        struct_shared[slot] = 0;
+        free_structs.push_back(slot);
+    }
+
+    void FreeBoxedInt(uint64_t slot)
+    {
+        if (slot < boxed_int_interned.size() && boxed_int_interned[slot])
+        {
+            interned_ints.erase(boxed_ints[slot]);
+            boxed_int_interned[slot] = 0;
+        }
+        boxed_ints[slot] = 0;
+        free_boxed_ints.push_back(slot);
+    }
 }
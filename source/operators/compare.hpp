@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "../types/variant.hpp"
+#include "../types/nan_box.hpp"
+#include "../types/expression.hpp"
+#include "../memory/memory.hpp"
+#include "../make_variant/get_variant.hpp"
+
+// Comparison of two values, shared by the comparison operators and builtins.
+// One comparator per pair of types, picked from a table indexed by both types.
+namespace Operators
+{
+    enum class ORDER : uint8_t
+    {
+        LESS,
+        EQUAL,
+        GREATER,
+        // Not equal and not ordered, like NaN or two different interned strings.
+        UNEQUAL,
+        // Values of unrelated types, never equal and not ordered. Ordering them is a type error
+        // for the operators, the builtins Greater and Lesser keep their old result of 0 instead.
+        MISMATCH,
+    };
+
+    // 'equality' is set when only EQUAL matters, comparators may then skip the ordering.
+    typedef ORDER (*Comparator)(const Variant &lhs, const Variant &rhs, bool equality);
+
+    namespace Comparators
+    {
+        template <typename T>
+        ORDER Ordered(T a, T b)
+        {
+            // NaN is found from its bits, -Ofast lets the compiler assume the comparisons below never see one.
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (Packed::IsNaN(a) || Packed::IsNaN(b))
+                    return ORDER::UNEQUAL;
+            }
+
+            if (a < b)
+                return ORDER::LESS;
+            if (a > b)
+                return ORDER::GREATER;
+            if (a == b)
+                return ORDER::EQUAL;
+            return ORDER::UNEQUAL;
+        }
+
+        ORDER IntInt(const Variant &lhs, const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(VarGetInt(lhs), VarGetInt(rhs));
+        }
+
+        ORDER IntFloat(const Variant &lhs, const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(static_cast<VarFloat>(VarGetInt(lhs)), VarGetFloat(rhs));
+        }
+
+        ORDER FloatInt(const Variant &lhs, const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(VarGetFloat(lhs), static_cast<VarFloat>(VarGetInt(rhs)));
+        }
+
+        ORDER FloatFloat(const Variant &lhs, const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(VarGetFloat(lhs), VarGetFloat(rhs));
+        }
+
+        // Null compares as 0 with numbers.
+        ORDER NilInt([[maybe_unused]] const Variant &lhs, const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(VarInt{0}, VarGetInt(rhs));
+        }
+
+        ORDER IntNil(const Variant &lhs, [[maybe_unused]] const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(VarGetInt(lhs), VarInt{0});
+        }
+
+        ORDER NilFloat([[maybe_unused]] const Variant &lhs, const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(0.0, VarGetFloat(rhs));
+        }
+
+        ORDER FloatNil(const Variant &lhs, [[maybe_unused]] const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return Ordered(VarGetFloat(lhs), 0.0);
+        }
+
+        ORDER NilNil([[maybe_unused]] const Variant &lhs, [[maybe_unused]] const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return ORDER::EQUAL;
+        }
+
+        // Compares the characters in place, equality is decided without them when the handles tell.
+        ORDER StringString(const Variant &lhs, const Variant &rhs, bool equality)
+        {
+            bool stored = VarIsStoredString(lhs) && VarIsStoredString(rhs);
+            if (VarIsInlineString(lhs) && VarIsInlineString(rhs))
+            {
+                // The unused bytes of an inline payload are zero, its length is part of the bits.
+                if (lhs.bits == rhs.bits)
+                    return ORDER::EQUAL;
+                if (equality)
+                    return ORDER::UNEQUAL;
+            }
+            else if (stored && lhs.bits == rhs.bits)
+            {
+                return ORDER::EQUAL;
+            }
+            else if (equality && stored && Memory::IsInternedString(VarGetHandle(lhs)) && Memory::IsInternedString(VarGetHandle(rhs)))
+            {
+                // Interned strings are unique, two slots hold two different strings.
+                return ORDER::UNEQUAL;
+            }
+
+            std::string_view a = VarGetString(lhs);
+            std::string_view b = VarGetString(rhs);
+            if (equality)
+                return a == b ? ORDER::EQUAL : ORDER::UNEQUAL;
+            int order = a.compare(b);
+            return order < 0 ? ORDER::LESS : (order > 0 ? ORDER::GREATER : ORDER::EQUAL);
+        }
+
+        ORDER Mismatch([[maybe_unused]] const Variant &lhs, [[maybe_unused]] const Variant &rhs, [[maybe_unused]] bool equality)
+        {
+            return ORDER::MISMATCH;
+        }
+    }
+
+    const size_t VALUE_TYPE_COUNT = static_cast<size_t>(VALUE_TYPE::STRUCT) + 1;
+    typedef std::array<std::array<Comparator, VALUE_TYPE_COUNT>, VALUE_TYPE_COUNT> ComparatorTable;
+
+    constexpr ComparatorTable MakeComparatorTable()
+    {
+        ComparatorTable table{};
+        for (auto &row : table)
+            row.fill(Comparators::Mismatch);
+
+        auto set = [&table](VALUE_TYPE lhs, VALUE_TYPE rhs, Comparator c)
+        {
+            table[static_cast<size_t>(lhs)][static_cast<size_t>(rhs)] = c;
+        };
+        set(VALUE_TYPE::INT, VALUE_TYPE::INT, Comparators::IntInt);
+        set(VALUE_TYPE::INT, VALUE_TYPE::FLOAT, Comparators::IntFloat);
+        set(VALUE_TYPE::FLOAT, VALUE_TYPE::INT, Comparators::FloatInt);
+        set(VALUE_TYPE::FLOAT, VALUE_TYPE::FLOAT, Comparators::FloatFloat);
+        set(VALUE_TYPE::NIL, VALUE_TYPE::INT, Comparators::NilInt);
+        set(VALUE_TYPE::INT, VALUE_TYPE::NIL, Comparators::IntNil);
+        set(VALUE_TYPE::NIL, VALUE_TYPE::FLOAT, Comparators::NilFloat);
+        set(VALUE_TYPE::FLOAT, VALUE_TYPE::NIL, Comparators::FloatNil);
+        set(VALUE_TYPE::NIL, VALUE_TYPE::NIL, Comparators::NilNil);
+        set(VALUE_TYPE::STRING, VALUE_TYPE::STRING, Comparators::StringString);
+        return table;
+    }
+
+    constexpr ComparatorTable COMPARATORS = MakeComparatorTable();
+
+    bool IsEquality(OPCODE op)
+    {
+        return op == OPCODE::EQ || op == OPCODE::NE;
+    }
+
+    ORDER Order(const Variant &lhs, const Variant &rhs, bool equality)
+    {
+        return COMPARATORS[static_cast<size_t>(VarType(lhs))][static_cast<size_t>(VarType(rhs))](lhs, rhs, equality);
+    }
+
+    // Whether comparison 'op' holds for values in 'order', MISMATCH is left to the caller.
+    bool Holds(OPCODE op, ORDER order)
+    {
+        switch (op)
+        {
+        case OPCODE::LT:
+            return order == ORDER::LESS;
+        case OPCODE::GT:
+            return order == ORDER::GREATER;
+        case OPCODE::LE:
+            return order == ORDER::LESS || order == ORDER::EQUAL;
+        case OPCODE::GE:
+            return order == ORDER::GREATER || order == ORDER::EQUAL;
+        case OPCODE::EQ:
+            return order == ORDER::EQUAL;
+        case OPCODE::NE:
+            return order != ORDER::EQUAL;
+        default:
+            return false;
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "../logger/logger.hpp"
+
+#include "../types/error.hpp"
+#include "../types/variant.hpp"
+#include "../types/expression.hpp"
+#include "../memory/memory.hpp"
+#include "../make_variant/get_variant.hpp"
+#include "../make_variant/make_variant.hpp"
+#include "compare.hpp"
+
+namespace Operators
+{
+    namespace
+    {
+        bool IsNumber(VALUE_TYPE type)
+        {
+            return type == VALUE_TYPE::INT || type == VALUE_TYPE::FLOAT;
+        }
+
+        VarFloat AsFloat(const Variant &v)
+        {
+            switch (VarType(v))
+            {
+            case VALUE_TYPE::INT:
+                return static_cast<VarFloat>(VarGetInt(v));
+            case VALUE_TYPE::FLOAT:
+                return VarGetFloat(v);
+            default:
+                return 0.0;
+            }
+        }
+
+        Variant MakeBool(bool b)
+        {
+            return VarMakeInt(b ? 1LL : 0LL);
+        }
+
+        const char *OpName(OPCODE op)
+        {
+            switch (op)
+            {
+            case OPCODE::NEG:
+                return "-";
+            case OPCODE::ADD:
+                return "+";
+            case OPCODE::SUB:
+                return "-";
+            case OPCODE::MUL:
+                return "*";
+            case OPCODE::DIV:
+                return "/";
+            case OPCODE::MOD:
+                return "%";
+            case OPCODE::LT:
+                return "<";
+            case OPCODE::GT:
+                return ">";
+            case OPCODE::LE:
+                return "<=";
+            case OPCODE::GE:
+                return ">=";
+            case OPCODE::EQ:
+                return "==";
+            case OPCODE::NE:
+                return "!=";
+            default:
+                return "?";
+            }
+        }
+
+        Error TypeError(OPCODE op)
+        {
+            Logger::Error("Type Error: unsupported operand types for operator", {OpName(op)});
+            return Error::REJECTED;
+        }
+    }
+
+    Error Negate(const Variant &v, Variant &out)
+    {
+        switch (VarType(v))
+        {
+        case VALUE_TYPE::INT:
+            out = VarMakeInt(std::bit_cast<VarInt>(0ULL - std::bit_cast<uint64_t>(VarGetInt(v))));
+            return Error::OK;
+        case VALUE_TYPE::FLOAT:
+            out = VarMakeFloat(-VarGetFloat(v));
+            return Error::OK;
+        default:
+            return TypeError(OPCODE::NEG);
+        }
+    }
+
+    Error IntArithmetic(OPCODE op, VarInt lhs, VarInt rhs, Variant &out)
+    {
+        // Computed on unsigned values so overflow wraps instead of being undefined.
+        uint64_t a = std::bit_cast<uint64_t>(lhs);
+        uint64_t b = std::bit_cast<uint64_t>(rhs);
+
+        switch (op)
+        {
+        case OPCODE::ADD:
+            out = VarMakeInt(std::bit_cast<VarInt>(a + b));
+            return Error::OK;
+        case OPCODE::SUB:
+            out = VarMakeInt(std::bit_cast<VarInt>(a - b));
+            return Error::OK;
+        case OPCODE::MUL:
+            out = VarMakeInt(std::bit_cast<VarInt>(a * b));
+            return Error::OK;
+        case OPCODE::DIV:
+        case OPCODE::MOD:
+            if (rhs == 0)
+            {
+                Logger::Error("Runtime Error: division by zero.", {});
+                return Error::REJECTED;
+            }
+            if (rhs == -1)
+            {
+                out = VarMakeInt(op == OPCODE::DIV ? std::bit_cast<VarInt>(0ULL - a) : 0LL);
+                return Error::OK;
+            }
+            out = VarMakeInt(op == OPCODE::DIV ? lhs / rhs : lhs % rhs);
+            return Error::OK;
+        default:
+            return TypeError(op);
+        }
+    }
+
+    Error FloatArithmetic(OPCODE op, VarFloat lhs, VarFloat rhs, Variant &out)
+    {
+        switch (op)
+        {
+        case OPCODE::ADD:
+            out = VarMakeFloat(lhs + rhs);
+            return Error::OK;
+        case OPCODE::SUB:
+            out = VarMakeFloat(lhs - rhs);
+            return Error::OK;
+        case OPCODE::MUL:
+            out = VarMakeFloat(lhs * rhs);
+            return Error::OK;
+        case OPCODE::DIV:
+            out = VarMakeFloat(lhs / rhs);
+            return Error::OK;
+        case OPCODE::MOD:
+            out = VarMakeFloat(std::fmod(lhs, rhs));
+            return Error::OK;
+        default:
+            return TypeError(op);
+        }
+    }
+
+    Error StringConcat(const Variant &lhs, const Variant &rhs, Variant &out)
+    {
+        // 'out' may alias an operand, read both before writing it.
+        std::string_view a = VarGetString(lhs);
+        std::string_view b = VarGetString(rhs);
+        std::string s;
+        s.reserve(a.size() + b.size());
+        s.append(a).append(b);
+        out = VarMakeString(std::move(s));
+        return Error::OK;
+    }
+
+    // Arithmetic between ints stays an int, any float operand makes a float.
+    Error Arithmetic(OPCODE op, const Variant &lhs, const Variant &rhs, Variant &out)
+    {
+        VALUE_TYPE lhs_type = VarType(lhs);
+        VALUE_TYPE rhs_type = VarType(rhs);
+        if (lhs_type == VALUE_TYPE::INT && rhs_type == VALUE_TYPE::INT)
+            return IntArithmetic(op, VarGetInt(lhs), VarGetInt(rhs), out);
+
+        if (IsNumber(lhs_type) && IsNumber(rhs_type))
+            return FloatArithmetic(op, AsFloat(lhs), AsFloat(rhs), out);
+
+        if (op == OPCODE::ADD && lhs_type == VALUE_TYPE::STRING && rhs_type == VALUE_TYPE::STRING)
+            return StringConcat(lhs, rhs, out);
+
+        return TypeError(op);
+    }
+
+    void IntCompare(OPCODE op, VarInt a, VarInt b, Variant &out)
+    {
+        out = MakeBool(Holds(op, Comparators::Ordered(a, b)));
+    }
+
+    void FloatCompare(OPCODE op, VarFloat a, VarFloat b, Variant &out)
+    {
+        out = MakeBool(Holds(op, Comparators::Ordered(a, b)));
+    }
+
+    void StringCompare(OPCODE op, const Variant &lhs, const Variant &rhs, Variant &out)
+    {
+        out = MakeBool(Holds(op, Comparators::StringString(lhs, rhs, IsEquality(op))));
+    }
+
+    // Numbers and null compare by value, strings lexicographically, see COMPARATORS.
+    // Values of unrelated types are never equal and cannot be ordered.
+    Error Compare(OPCODE op, const Variant &lhs, const Variant &rhs, Variant &out)
+    {
+        ORDER order = Order(lhs, rhs, IsEquality(op));
+        if (order == ORDER::MISMATCH && !IsEquality(op))
+            return TypeError(op);
+
+        out = MakeBool(Holds(op, order));
+        return Error::OK;
+    }
+
+    bool IsArithmetic(OPCODE op)
+    {
+        return op == OPCODE::ADD || op == OPCODE::SUB || op == OPCODE::MUL ||
+               op == OPCODE::DIV || op == OPCODE::MOD;
+    }
+
+    Error Binary(OPCODE op, const Variant &lhs, const Variant &rhs, Variant &out)
+    {
+        if (IsArithmetic(op))
+            return Arithmetic(op, lhs, rhs, out);
+        return Compare(op, lhs, rhs, out);
+    }
+}
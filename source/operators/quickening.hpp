@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../types/error.hpp"
+#include "../types/variant.hpp"
+#include "../types/expression.hpp"
+#include "../make_variant/get_variant.hpp"
+
+#include "operators.hpp"
+
+// Binary expression ops start generic. The first execution rewrites the op into
+// the specialization matching its operand types, later executions only check
+// the types against it. A failed check sends the op back to the generic form for good.
+namespace Quickening
+{
+    struct Counters
+    {
+        size_t quickened = 0;
+        size_t deoptimized = 0;
+    };
+
+    Counters counters{};
+
+    namespace
+    {
+        QUICK SpecializationFor(OPCODE op, VALUE_TYPE lhs, VALUE_TYPE rhs)
+        {
+            if (lhs != rhs)
+                return QUICK::GENERIC;
+
+            switch (lhs)
+            {
+            case VALUE_TYPE::INT:
+                return QUICK::INT_INT;
+            case VALUE_TYPE::FLOAT:
+                return QUICK::FLOAT_FLOAT;
+            case VALUE_TYPE::STRING:
+                if (op == OPCODE::ADD || !Operators::IsArithmetic(op))
+                    return QUICK::STRING_STRING;
+                return QUICK::GENERIC;
+            default:
+                return QUICK::GENERIC;
+            }
+        }
+
+        bool GuardHolds(QUICK quick, VALUE_TYPE lhs, VALUE_TYPE rhs)
+        {
+            switch (quick)
+            {
+            case QUICK::INT_INT:
+                return lhs == VALUE_TYPE::INT && rhs == VALUE_TYPE::INT;
+            case QUICK::FLOAT_FLOAT:
+                return lhs == VALUE_TYPE::FLOAT && rhs == VALUE_TYPE::FLOAT;
+            case QUICK::STRING_STRING:
+                return lhs == VALUE_TYPE::STRING && rhs == VALUE_TYPE::STRING;
+            default:
+                return false;
+            }
+        }
+
+        Error RunSpecialized(ExprOp &op, const Variant &lhs, const Variant &rhs, Variant &out)
+        {
+            bool arithmetic = Operators::IsArithmetic(op.code);
+
+            switch (op.quick)
+            {
+            case QUICK::INT_INT:
+                if (arithmetic)
+                    return Operators::IntArithmetic(op.code, VarGetInt(lhs), VarGetInt(rhs), out);
+                Operators::IntCompare(op.code, VarGetInt(lhs), VarGetInt(rhs), out);
+                return Error::OK;
+            case QUICK::FLOAT_FLOAT:
+                if (arithmetic)
+                    return Operators::FloatArithmetic(op.code, VarGetFloat(lhs), VarGetFloat(rhs), out);
+                Operators::FloatCompare(op.code, VarGetFloat(lhs), VarGetFloat(rhs), out);
+                return Error::OK;
+            case QUICK::STRING_STRING:
+                if (arithmetic)
+                    return Operators::StringConcat(lhs, rhs, out);
+                Operators::StringCompare(op.code, lhs, rhs, out);
+                return Error::OK;
+            default:
+                return Operators::Binary(op.code, lhs, rhs, out);
+            }
+        }
+    }
+
+    // Evaluates a binary op, quickening or deoptimizing it as needed.
+    Error Binary(ExprOp &op, const Variant &lhs, const Variant &rhs, Variant &out)
+    {
+        switch (op.quick)
+        {
+        case QUICK::GENERIC:
+            return Operators::Binary(op.code, lhs, rhs, out);
+        case QUICK::UNSEEN:
+            op.quick = SpecializationFor(op.code, VarType(lhs), VarType(rhs));
+            if (op.quick != QUICK::GENERIC)
+                ++counters.quickened;
+            return RunSpecialized(op, lhs, rhs, out);
+        default:
+            if (GuardHolds(op.quick, VarType(lhs), VarType(rhs)))
+                return RunSpecialized(op, lhs, rhs, out);
+
+            op.quick = QUICK::GENERIC;
+            ++counters.deoptimized;
+            return Operators::Binary(op.code, lhs, rhs, out);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#if _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Buffered standard output of the scripts, written with one write(2) per full buffer.
+// Anything else writing to stdout flushes it first, so the order of the output is kept.
+namespace Output
+{
+    const size_t BUFFER_SIZE = 64 * 1024;
+
+    char buffer[BUFFER_SIZE];
+    size_t used = 0;
+    // Flush at every newline, set with --line-buffered or when stdout is a terminal.
+    bool line_buffered = false;
+    // Stream taking the output instead of stdout, see Script::RunFileCaptured.
+    std::ostream *capture = nullptr;
+
+    namespace
+    {
+        void WriteAll(const char *data, size_t size)
+        {
+            if (capture)
+            {
+                capture->write(data, static_cast<std::streamsize>(size));
+                return;
+            }
+
+            // Whatever went through std::cout comes first.
+            std::cout.flush();
+            while (size)
+            {
+#if _WIN32
+                int written = _write(1, data, static_cast<unsigned int>(size));
+#else
+                ssize_t written = write(STDOUT_FILENO, data, size);
+#endif
+                if (written < 0 && errno == EINTR)
+                    continue;
+                if (written <= 0)
+                    return;
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+    }
+
+    bool IsTerminal()
+    {
+#if _WIN32
+        return _isatty(1);
+#else
+        return isatty(STDOUT_FILENO);
+#endif
+    }
+
+    void Flush()
+    {
+        if (!used)
+            return;
+        WriteAll(buffer, used);
+        used = 0;
+    }
+
+    void Write(std::string_view s)
+    {
+        if (used + s.size() > BUFFER_SIZE)
+        {
+            Flush();
+            // Too big to buffer, goes out in one write.
+            if (s.size() > BUFFER_SIZE)
+            {
+                WriteAll(s.data(), s.size());
+                return;
+            }
+        }
+        std::memcpy(buffer + used, s.data(), s.size());
+        used += s.size();
+    }
+
+    // Ends a line, the place where a line buffered output is flushed.
+    void EndLine()
+    {
+        Write("\n");
+        if (line_buffered)
+            Flush();
+    }
+}
@@ -9,9 +9,23 @@
 #include "../types/error.hpp"
 #include "../types/token.hpp"
 #include "../types/variant.hpp"
+#include "../compiler/control_flow.hpp"
+#include "../compiler/expression.hpp"
+#include "../compiler/call.hpp"
+#include "../compiler/escape.hpp"
 
 namespace Parser
 {
+    bool HasExpressionToken(const std::vector<Token::Token> &tokens, size_t first)
+    {
+        for (size_t i = first; i < tokens.size(); ++i)
+        {
+            if (Compiler::IsExpressionToken(tokens.at(i).type))
+                return true;
+        }
+        return false;
+    }
+
     Error HandleInstruction(const std::vector<Token::Token> &tokens, std::vector<Scope *> &scope_stack)
     {
         if (!tokens.size())
@@ -36,6 +50,12 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            if (inst_size > 4)
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 3);
+                if (expr_err)
+                    return expr_err;
+            }
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -52,6 +72,12 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            if (inst_size > 4)
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 3);
+                if (expr_err)
+                    return expr_err;
+            }
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -68,6 +94,12 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            if (inst_size > 4)
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 3);
+                if (expr_err)
+                    return expr_err;
+            }
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -100,6 +132,9 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            Error args_err = Compiler::CompileCallArguments(inst, 3);
+            if (args_err)
+                return args_err;
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -116,6 +151,12 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            if (inst_size > 1)
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 1);
+                if (expr_err)
+                    return expr_err;
+            }
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -143,6 +184,11 @@ namespace Parser
                     });
             }
 
+            Error jump_err = Compiler::ResolveJumps(*scope_stack.back());
+            if (jump_err)
+                return jump_err;
+            Compiler::MarkLocalTargets(*scope_stack.back());
+
             scope_stack.pop_back();
             break;
         }
@@ -163,9 +209,6 @@ namespace Parser
                 .insert({tokens.at(1).content, Scope{
                                                    .type = SCOPE_TYPE::CLASS,
                                                    .parent = scope_stack.back(),
-                                                   .runtime_vars = {
-                                                       .if_depth = 0,
-                                                   },
                                                    .name = tokens.at(1).content,
                                                    .args = {},
                                                    .vars = {},
@@ -176,7 +219,7 @@ namespace Parser
         }
         case Token::KEYW_NAMESPACE:
         {
-            Logger::Debug("Parser: parsing namespace", {tokens.at(1).content});
+            LOG_DEBUG("Parser: parsing namespace", {tokens.at(1).content});
             if (inst_size < 2)
             {
                 Logger::Error("Syntax Error: 'namespace' instruction requires 1 argument.", {});
@@ -192,9 +235,6 @@ namespace Parser
                 .emplace(std::make_pair(tokens.at(1).content, Scope{
                                                                   .type = SCOPE_TYPE::NAMESPACE,
                                                                   .parent = scope_stack.back(),
-                                                                  .runtime_vars = {
-                                                                      .if_depth = 0,
-                                                                  },
                                                                   .name = std::string(tokens.at(1).content),
                                                                   .args = {},
                                                                   .vars = {},
@@ -221,9 +261,6 @@ namespace Parser
                          Scope{
                              .type = SCOPE_TYPE::FUNC,
                              .parent = scope_stack.back(),
-                             .runtime_vars = {
-                                 .if_depth = 0,
-                             },
                              .name = tokens.at(1).content,
                              .args = {},
                              .vars = {},
@@ -237,10 +274,7 @@ namespace Parser
                 if (tokens.at(i).type != Token::NAME)
                     continue;
                 scope_stack.back()
-                    ->args.push_back({tokens.at(i).content, Variant{
-                                                                .type = VALUE_TYPE::NIL,
-                                                                .d64 = 0,
-                                                            }});
+                    ->args.push_back({tokens.at(i).content, NIL_VALUE});
             }
             break;
         }
@@ -257,6 +291,10 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            Error args_err = Compiler::CompileCallArguments(inst, 5);
+            if (args_err)
+                return args_err;
+            inst.owns_first_arg = inst.args.size() > 5 && inst.args[5].type == Token::NAME && inst.args[5].content == inst.args[1].content;
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -294,6 +332,18 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            if (HasExpressionToken(tokens, 1))
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 1);
+                if (expr_err)
+                    return expr_err;
+            }
+            else
+            {
+                Error args_err = Compiler::CompileCallArguments(inst, 3);
+                if (args_err)
+                    return args_err;
+            }
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -310,6 +360,18 @@ namespace Parser
             };
             for (const Token::Token &tok : tokens)
                 inst.args.push_back(tok);
+            if (HasExpressionToken(tokens, 1))
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 1);
+                if (expr_err)
+                    return expr_err;
+            }
+            else
+            {
+                Error args_err = Compiler::CompileCallArguments(inst, 3);
+                if (args_err)
+                    return args_err;
+            }
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
@@ -335,6 +397,69 @@ namespace Parser
             scope_stack.back()->instructions.push_back(inst);
             break;
         }
+        case Token::KEYW_WHILE:
+        {
+            if (inst_size < 2)
+            {
+                Logger::Error("Syntax Error: 'while' instruction requires at least 1 argument.", {});
+                return Error::SYNTAX;
+            }
+            Instruction inst = {
+                .type = Token::KEYW_WHILE,
+                .args = {},
+            };
+            for (const Token::Token &tok : tokens)
+                inst.args.push_back(tok);
+            if (HasExpressionToken(tokens, 1))
+            {
+                Error expr_err = Compiler::CompileExpression(inst, 1);
+                if (expr_err)
+                    return expr_err;
+            }
+            else
+            {
+                Error args_err = Compiler::CompileCallArguments(inst, 3);
+                if (args_err)
+                    return args_err;
+            }
+            scope_stack.back()->instructions.push_back(inst);
+            break;
+        }
+        case Token::KEYW_FOR:
+        {
+            if (inst_size < 6)
+            {
+                Logger::Error("Syntax Error: 'for' instruction requires at least 3 arguments 'name', 'start' and 'end'.", {});
+                return Error::SYNTAX;
+            }
+            if (tokens.at(1).type != Token::NAME)
+            {
+                Logger::Error("Syntax Error: first argument of 'for' must be a name.", {});
+                return Error::SYNTAX;
+            }
+            Instruction inst = {
+                .type = Token::KEYW_FOR,
+                .args = {},
+            };
+            for (const Token::Token &tok : tokens)
+                inst.args.push_back(tok);
+            scope_stack.back()->instructions.push_back(inst);
+            break;
+        }
+        case Token::KEYW_ENDWHILE:
+        case Token::KEYW_ENDFOR:
+        case Token::KEYW_BREAK:
+        case Token::KEYW_CONTINUE:
+        {
+            Instruction inst = {
+                .type = inst_type,
+                .args = {},
+            };
+            for (const Token::Token &tok : tokens)
+                inst.args.push_back(tok);
+            scope_stack.back()->instructions.push_back(inst);
+            break;
+        }
         default:
             break;
         }
@@ -343,7 +468,7 @@ namespace Parser
 
     Error ParseTokens(const std::vector<Token::Token> &tokens, Scope &out_global)
     {
-        Logger::Debug("Starting token parsing.", {});
+        LOG_DEBUG("Starting token parsing.", {});
 
         std::vector<Token::Token> inst_buffer = {};
 
@@ -371,7 +496,11 @@ namespace Parser
             return Error::SYNTAX;
         }
 
-        Logger::Debug("Finished token parsing.", {});
+        Error jump_err = Compiler::ResolveJumps(out_global);
+        if (jump_err)
+            return jump_err;
+
+        LOG_DEBUG("Finished token parsing.", {});
 
         return Error::OK;
     }
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../logger/logger.hpp"
+#include "../types/error.hpp"
+#include "../types/scope.hpp"
+#include "../types/call_frame.hpp"
+#include "../registers/registers.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GVS_PROFILER_SUPPORTED 1
+#include <csignal>
+#include <sys/time.h>
+#else
+#define GVS_PROFILER_SUPPORTED 0
+#endif
+
+// Sampling profiler enabled with --profile.
+// A SIGPROF timer copies the interpreter's call frames into a preallocated buffer,
+// the samples are folded into one line per distinct stack at exit ('a;b;c count'),
+// the input format of flamegraph.pl and speedscope.
+namespace Profiler
+{
+    const size_t DEFAULT_HZ = 1000;
+    // Deeper stacks keep their outermost frames.
+    const size_t MAX_SAMPLE_DEPTH = 256;
+    // Frames and sample headers, 16 bytes each.
+    const size_t BUFFER_ENTRIES = 1 << 20;
+
+    // A sample is a header entry (scope == nullptr, ip == depth) followed by its frames, outermost first.
+    struct SampleEntry
+    {
+        const Scope *scope;
+        size_t ip;
+    };
+
+    bool enabled = false;
+    size_t hz = DEFAULT_HZ;
+
+    std::vector<SampleEntry> buffer = {};
+    // Only the signal handler writes while the timer runs, the report reads after it stops.
+    std::atomic<size_t> used = 0;
+    std::atomic<size_t> samples = 0;
+    std::atomic<size_t> dropped = 0;
+
+    bool IsSupported()
+    {
+        return GVS_PROFILER_SUPPORTED;
+    }
+
+    // Async-signal-safe: reads the frame chain and writes into memory allocated up front.
+    void TakeSample()
+    {
+        size_t depth = Registers::frame_depth.load(std::memory_order_acquire);
+        if (!depth)
+            return;
+        if (depth > MAX_SAMPLE_DEPTH)
+            depth = MAX_SAMPLE_DEPTH;
+
+        size_t at = used.load(std::memory_order_relaxed);
+        if (at + depth + 1 > buffer.size())
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer[at] = SampleEntry{
+            .scope = nullptr,
+            .ip = depth,
+        };
+        for (size_t i = 0; i < depth; ++i)
+        {
+            buffer[at + 1 + i] = SampleEntry{
+                .scope = Registers::frames[i].scope,
+                .ip = Registers::frames[i].ip,
+            };
+        }
+        used.store(at + depth + 1, std::memory_order_release);
+        samples.fetch_add(1, std::memory_order_relaxed);
+    }
+
+#if GVS_PROFILER_SUPPORTED
+    namespace
+    {
+        struct sigaction previous_action = {};
+
+        void OnProfilingSignal([[maybe_unused]] int sig)
+        {
+            TakeSample();
+        }
+
+        void SetTimer(size_t rate)
+        {
+            itimerval timer = {};
+            if (rate)
+            {
+                timer.it_interval.tv_sec = 0;
+                timer.it_interval.tv_usec = static_cast<suseconds_t>(rate >= 1000000 ? 1 : 1000000 / rate);
+                timer.it_value = timer.it_interval;
+            }
+            setitimer(ITIMER_PROF, &timer, nullptr);
+        }
+    }
+
+    Error Start()
+    {
+        buffer.assign(BUFFER_ENTRIES, SampleEntry{});
+        used = 0;
+        samples = 0;
+        dropped = 0;
+
+        struct sigaction action = {};
+        action.sa_handler = OnProfilingSignal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, &previous_action) != 0)
+        {
+            Logger::Error("Profiler: could not install the SIGPROF handler.", {});
+            return Error::REJECTED;
+        }
+
+        SetTimer(hz);
+        return Error::OK;
+    }
+
+    void Stop()
+    {
+        SetTimer(0);
+        sigaction(SIGPROF, &previous_action, nullptr);
+    }
+#else
+    Error Start()
+    {
+        return Error::REJECTED;
+    }
+
+    void Stop()
+    {
+    }
+#endif
+
+    namespace
+    {
+        // 'Namespace.Function:line', the line of the instruction the frame was executing.
+        std::string FrameLabel(const SampleEntry &entry)
+        {
+            std::string label = QualifiedScopeName(*entry.scope);
+            if (entry.ip < entry.scope->instructions.size() && entry.scope->instructions[entry.ip].args.size())
+                label += ":" + std::to_string(entry.scope->instructions[entry.ip].args[0].line);
+            return label;
+        }
+    }
+
+    // Folds the samples into 'outer;...;inner count' lines, must run while the sampled scopes are alive.
+    Error WriteFolded(const std::string &path)
+    {
+        std::map<std::string, size_t> folded{};
+        size_t end = used.load(std::memory_order_acquire);
+
+        for (size_t at = 0; at < end;)
+        {
+            size_t depth = buffer[at].ip;
+            std::string stack;
+            for (size_t i = 0; i < depth; ++i)
+            {
+                if (i)
+                    stack += ";";
+                stack += FrameLabel(buffer[at + 1 + i]);
+            }
+            ++folded[stack];
+            at += depth + 1;
+        }
+
+        std::ofstream out(path);
+        if (!out)
+        {
+            Logger::Error("Profiler: could not open output file", {path});
+            return Error::REJECTED;
+        }
+        for (const auto &[stack, count] : folded)
+            out << stack << " " << count << "\n";
+
+        Logger::Info("Profiler: wrote", {std::to_string(samples.load()), "samples to", path,
+                                         "dropped:", std::to_string(dropped.load())});
+        return Error::OK;
+    }
+}
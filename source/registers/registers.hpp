@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "../types/variant.hpp"
+#include "../types/loop_counter.hpp"
+#include "../types/call_frame.hpp"
+
+namespace Registers
+{
+    // Read-only name under which scripts can still access the return register.
+    const std::string RET_VAL_NAME{"retVal"};
+
+    // Holds the value of the latest return or builtin call.
+    Variant ret_val = NIL_VALUE;
+
+    // Set for 'fetch a, F, a, ...', whose result replaces the first argument of a builtin,
+    // so the builtin may write the store of that argument in place.
+    bool first_arg_owned = false;
+    // Set when the return register holds the only handle of its array, map or typed array,
+    // as a builtin returns after writing its first argument, see BuiltinFuncs::WritableArg.
+    bool ret_unshared = false;
+
+    const size_t ARG_STACK_SIZE = 256;
+    const size_t LOOP_STACK_SIZE = 16384;
+    const size_t MAX_CALL_DEPTH = 16384;
+
+    // Arguments of the builtin call in progress, passed to it as a span.
+    Variant arg_stack[ARG_STACK_SIZE] = {};
+    size_t arg_top = 0;
+
+    // 'for' counters of every scope on the call stack.
+    LoopCounter loop_stack[LOOP_STACK_SIZE] = {};
+    size_t loop_top = 0;
+
+    // Scopes being executed, innermost last. Read asynchronously by the sampling profiler,
+    // so a frame is written before the depth is raised to include it.
+    CallFrame frames[MAX_CALL_DEPTH] = {};
+    std::atomic<size_t> frame_depth = 0;
+
+    CallFrame &CurrentFrame()
+    {
+        return frames[frame_depth.load(std::memory_order_relaxed) - 1];
+    }
+
+    void Reset()
+    {
+        arg_top = 0;
+        loop_top = 0;
+        first_arg_owned = false;
+        ret_unshared = false;
+        frame_depth.store(0, std::memory_order_release);
+        ret_val = NIL_VALUE;
+    }
+}
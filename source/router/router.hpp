@@ -9,11 +9,119 @@
 #include "../help/help.hpp"
 #include "../version/version.hpp"
 #include "../script/run_script.hpp"
+#include "../jit/jit.hpp"
+#include "../stats/stats.hpp"
+#include "../profiler/profiler.hpp"
+#include "../memory/memory.hpp"
+#include "../output/output.hpp"
 
 namespace Router
 {
+    Error ConfigureJit()
+    {
+        bool diff = Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_JIT_DIFF);
+        Jit::enabled = Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_JIT);
+
+        // Compile on the first call when diffing so every called function goes through the JIT.
+        Jit::threshold = diff ? 1 : Jit::DEFAULT_THRESHOLD;
+
+        if (Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_JIT_THRESHOLD))
+        {
+            const std::string &value = Global::args.at(Arguments::ARG_JIT_THRESHOLD);
+            try
+            {
+                size_t pos = 0;
+                Jit::threshold = std::stoull(value, &pos);
+                if (pos != value.size() || !Jit::threshold)
+                    throw std::invalid_argument(value);
+            }
+            catch ([[maybe_unused]] const std::exception &e)
+            {
+                Logger::Error("Expected a positive integer for argument", {Arguments::ARG_JIT_THRESHOLD, "got:", value});
+                return Error::ASSERTION;
+            }
+        }
+
+        if ((Jit::enabled || diff) && !Jit::IsSupported())
+        {
+            Logger::Warning("JIT is only available on x86-64 Linux, running interpreted.", {});
+            Jit::enabled = false;
+        }
+        return Error::OK;
+    }
+
+    Error ConfigureLogLevel()
+    {
+        if (!Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_LOG_LEVEL))
+            return Error::OK;
+
+        const std::string &value = Global::args.at(Arguments::ARG_LOG_LEVEL);
+        if (!Logger::ParseLevel(value, Logger::level))
+        {
+            Logger::Error("Expected one of debug, info, warning, error, none for argument", {Arguments::ARG_LOG_LEVEL, "got:", value});
+            return Error::ASSERTION;
+        }
+        return Error::OK;
+    }
+
+    Error ConfigureStats()
+    {
+        if (!Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_STATS))
+            return Error::OK;
+
+        const std::string &format = Global::args.at(Arguments::ARG_STATS);
+        if (format != "" && format != "text" && format != "json")
+        {
+            Logger::Error("Expected text or json for argument", {Arguments::ARG_STATS, "got:", format});
+            return Error::ASSERTION;
+        }
+        Stats::enabled = true;
+        Stats::json = format == "json";
+        return Error::OK;
+    }
+
+    Error ConfigureProfiler()
+    {
+        if (!Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_PROFILE))
+            return Error::OK;
+
+        if (Global::args.at(Arguments::ARG_PROFILE).empty())
+        {
+            Logger::Error("Expected an output file for argument", {Arguments::ARG_PROFILE});
+            return Error::ASSERTION;
+        }
+
+        if (Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_PROFILE_HZ))
+        {
+            const std::string &value = Global::args.at(Arguments::ARG_PROFILE_HZ);
+            try
+            {
+                size_t pos = 0;
+                Profiler::hz = std::stoull(value, &pos);
+                if (pos != value.size() || !Profiler::hz)
+                    throw std::invalid_argument(value);
+            }
+            catch ([[maybe_unused]] const std::exception &e)
+            {
+                Logger::Error("Expected a positive integer for argument", {Arguments::ARG_PROFILE_HZ, "got:", value});
+                return Error::ASSERTION;
+            }
+        }
+
+        if (!Profiler::IsSupported())
+        {
+            Logger::Warning("Profiler is only available on POSIX systems, running without it.", {});
+            return Error::OK;
+        }
+        Profiler::enabled = true;
+        return Error::OK;
+    }
+
     Error RouteBasedOnArguments()
     {
+        Error log_err = ConfigureLogLevel();
+        if (log_err)
+            return log_err;
 
         if (Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_HELP))
         {
@@ -29,6 +137,23 @@ namespace Router
 
         if (Helper::UnorderedMapHasKey(Global::args, std::string{"PATH"}))
         {
+            Error jit_err = ConfigureJit();
+            if (jit_err)
+                return jit_err;
+
+            Error stats_err = ConfigureStats();
+            if (stats_err)
+                return stats_err;
+
+            Error profiler_err = ConfigureProfiler();
+            if (profiler_err)
+                return profiler_err;
+
+            Memory::track_sites = Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_MEM_REPORT);
+            Output::line_buffered = Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_LINE_BUFFERED) || Output::IsTerminal();
+
+            if (Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_JIT_DIFF))
+                return Script::RunFileJitDiff(Global::args.at("PATH"));
             return Script::RunFile(Global::args.at("PATH"));
         }
 
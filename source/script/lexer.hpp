@@ -33,6 +33,9 @@ public:
     uint16_t line = 1;
     uint16_t tok_col = 1;
     uint16_t tok_line = 1;
+    // Position of the last consumed char.
+    uint16_t char_col = 1;
+    uint16_t char_line = 1;
     std::vector<char> tok_buff = {};
     std::vector<Token::Token> &tokens;
 
@@ -67,7 +70,20 @@ public:
 
     char ConsumeChar()
     {
+        char_line = line;
+        char_col = col;
+
         char c = line_str[line_idx++];
+        if (c == '\n')
+        {
+            ++line;
+            col = 1;
+        }
+        else
+        {
+            ++col;
+        }
+
         if (line_idx >= line_str.size())
         {
             ReadLineFromFile();
@@ -97,11 +113,20 @@ public:
             .col = tok_col,
         };
 
-        Logger::Debug("PUSHED:", {t.content, "\t:\t", Token::TYPE_TO_STR.at(t.type)});
+        LOG_DEBUG("PUSHED:", {t.content, "\t:\t", Token::TYPE_TO_STR.at(t.type)});
         tokens.push_back(t);
         tok_buff.clear();
-        tok_line = line;
-        tok_col = col;
+    }
+
+    // Appends the last consumed char to the token buffer, a token is located at its first char.
+    void BufferChar(char c)
+    {
+        if (!tok_buff.size())
+        {
+            tok_line = char_line;
+            tok_col = char_col;
+        }
+        tok_buff.push_back(c);
     }
 
     bool IsComment(const char c)
@@ -175,6 +200,8 @@ public:
         {
             PushTokenBuffer(TryMatchTokenBuffer());
             lex_mode = LEX_MODE::STRING;
+            tok_line = char_line;
+            tok_col = char_col;
         }
     }
 
@@ -209,11 +236,32 @@ public:
                 return Token::NONE;
             }
 
+            // Kept in buffer when it starts a negative number, otherwise it is an operator,
+            // so '-a' and '5-a' lex as a minus before the name.
+            if (c == '-' && tok_buff.empty() && isNumeric(PeakChar()) && PeakChar() != '-')
+            {
+                return Token::NONE;
+            }
+
             return GravelRules::TOK_LOOKUP_TABLE.at(schar);
         }
         return Token::NONE;
     }
 
+    Token::TYPE TryMatchCharPairToken(char c)
+    {
+        // Only operators are made of two symbols, two letters may start a keyword or name.
+        if (isAlphaNumeric(c) || isAlphaNumeric(PeakChar()))
+            return Token::NONE;
+
+        std::string pair = {c, PeakChar()};
+        if (Helper::MapHasKey(GravelRules::TOK_LOOKUP_TABLE, pair))
+        {
+            return GravelRules::TOK_LOOKUP_TABLE.at(pair);
+        }
+        return Token::NONE;
+    }
+
     Token::TYPE TryMatchTokenBuffer()
     {
         std::string tok = std::string(tok_buff.begin(), tok_buff.end());
@@ -261,7 +309,7 @@ namespace Script
 {
     Error LexFile(const std::string &script_path, std::vector<Token::Token> &out_tokens)
     {
-        Logger::Debug("Lexing file:", {script_path});
+        LOG_DEBUG("Lexing file:", {script_path});
         Lexer lexer = Lexer(script_path, out_tokens);
 
         while (!lexer.IsEndOfFile())
@@ -315,17 +363,28 @@ namespace Script
 
             if (lexer.lex_mode == lexer.STRING)
             {
-                lexer.tok_buff.push_back(c);
+                lexer.BufferChar(c);
                 lexer.escape_next = false;
                 continue;
             }
 
+            // Try matching two-char tokens
+            Token::TYPE pair_tok_type = lexer.TryMatchCharPairToken(c);
+            if (pair_tok_type != Token::NONE)
+            {
+                lexer.PushTokenBuffer(lexer.TryMatchTokenBuffer());
+                lexer.BufferChar(c);
+                lexer.tok_buff.push_back(lexer.ConsumeChar());
+                lexer.PushTokenBuffer(pair_tok_type);
+                continue;
+            }
+
             // Try matching single-char tokens
             Token::TYPE char_tok_type = lexer.TryMatchCharToken(c);
             if (char_tok_type != Token::NONE)
             {
                 lexer.PushTokenBuffer(lexer.TryMatchTokenBuffer());
-                lexer.tok_buff.push_back(c);
+                lexer.BufferChar(c);
                 lexer.PushTokenBuffer(char_tok_type);
                 continue;
             }
@@ -335,7 +394,7 @@ namespace Script
                 lexer.PushTokenBuffer(lexer.TryMatchTokenBuffer());
                 continue;
             }
-            lexer.tok_buff.push_back(c);
+            lexer.BufferChar(c);
         }
 
         return Error::OK;
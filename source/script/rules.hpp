@@ -12,6 +12,20 @@ namespace GravelRules
         {".", Token::DOT},
         {",", Token::COMMA},
         {";", Token::SEMI_COLON},
+        /* operators, '-' is only matched alone so it can prefix numbers */
+        {"+", Token::OP_ADD},
+        {"-", Token::OP_SUB},
+        {"*", Token::OP_MUL},
+        {"/", Token::OP_DIV},
+        {"%", Token::OP_MOD},
+        {"<", Token::OP_LT},
+        {">", Token::OP_GT},
+        {"<=", Token::OP_LE},
+        {">=", Token::OP_GE},
+        {"==", Token::OP_EQ},
+        {"!=", Token::OP_NE},
+        {"(", Token::PAREN_OPEN},
+        {")", Token::PAREN_CLOSE},
         /* reserved word */
         {"set", Token::KEYW_SET},
         {"const", Token::KEYW_CONST},
@@ -29,5 +43,11 @@ namespace GravelRules
         {"else", Token::KEYW_ELSE},
         {"endif", Token::KEYW_ENDIF},
         {"fetch", Token::KEYW_FETCH},
+        {"while", Token::KEYW_WHILE},
+        {"endwhile", Token::KEYW_ENDWHILE},
+        {"for", Token::KEYW_FOR},
+        {"endfor", Token::KEYW_ENDFOR},
+        {"break", Token::KEYW_BREAK},
+        {"continue", Token::KEYW_CONTINUE},
     };
 }
\ No newline at end of file
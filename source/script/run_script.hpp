@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 #include "../types/error.hpp"
@@ -11,6 +12,17 @@
 #include "lexer.hpp"
 #include "../parser/parser.hpp"
 #include "../interpreter/interpreter.hpp"
+#include "../operators/quickening.hpp"
+#include "../jit/jit.hpp"
+#include "../stats/stats.hpp"
+#include "../profiler/profiler.hpp"
+#include "../trace/trace.hpp"
+#include "../memory/mem_report.hpp"
+#include "../memory/gc.hpp"
+#include "../arguments/parse_arguments.hpp"
+#include "../global_state/global_state.hpp"
+#include "../helper/helper.hpp"
+#include "../output/output.hpp"
 
 namespace Script
 {
@@ -22,15 +34,16 @@ namespace Script
         if (lex_err)
             return lex_err;
 
-#if !GVS_RELEASE
-        Logger::Debug("Tokens size:", {std::to_string(tokens.size())});
-
-        for (Token::Token t : tokens)
+        if (Logger::IsEnabled(LOG_LEVEL::DEBUG))
         {
-            std::cout << t.content << ((t.type == Token::SEMI_COLON) ? "\n" : " ");
+            LOG_DEBUG("Tokens size:", {std::to_string(tokens.size())});
+
+            for (const Token::Token &t : tokens)
+            {
+                std::cout << t.content << ((t.type == Token::SEMI_COLON) ? "\n" : " ");
+            }
+            std::cout << "\n";
         }
-        std::cout << "\n";
-#endif
 
         Scope global{
             .type = SCOPE_TYPE::GLOBAL,
@@ -45,10 +58,138 @@ namespace Script
         if (parse_err)
             return parse_err;
 
-        Error interpret_err = Interpreter::InterpretGlobalScope(global);
+        if (Profiler::enabled)
+        {
+            Error profiler_err = Profiler::Start();
+            if (profiler_err)
+                return profiler_err;
+        }
+
+        Trace::Reset();
+        Gc::root = &global;
+        Error interpret_err = Error::OK;
+        try
+        {
+            interpret_err = Interpreter::InterpretGlobalScope(global);
+        }
+        catch (...)
+        {
+            Gc::root = nullptr;
+            Output::Flush();
+            // Dumped here while the scopes it points to are still alive, main reports the exception.
+            if (Profiler::enabled)
+                Profiler::Stop();
+            Trace::Dump(std::cerr);
+            throw;
+        }
+
+        // The script output goes out before the reports.
+        Output::Flush();
+
+        if (Profiler::enabled)
+        {
+            Profiler::Stop();
+            Error write_err = Profiler::WriteFolded(Global::args.at(Arguments::ARG_PROFILE));
+            if (write_err && !interpret_err)
+                interpret_err = write_err;
+        }
+
+        if (Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_QUICKEN_STATS))
+        {
+            Logger::Info("Quickened sites:", {std::to_string(Quickening::counters.quickened),
+                                              "deoptimized sites:", std::to_string(Quickening::counters.deoptimized)});
+        }
+
+        if (Stats::enabled)
+            Stats::Report(std::cerr);
+
+        if (Memory::track_sites)
+            MemReport::Report(std::cerr);
+
+        if (Helper::UnorderedMapHasKey(Global::args, Arguments::ARG_GC_STATS))
+            Gc::Report(std::cerr);
+
+        Gc::root = nullptr;
+
         if (interpret_err)
             return interpret_err;
 
         return Error::OK;
     }
+
+    // Runs the script with stdout captured into 'out'.
+    Error RunFileCaptured(const std::string &script_path, std::string &out)
+    {
+        std::ostringstream captured;
+        Output::Flush();
+        std::streambuf *previous = std::cout.rdbuf(captured.rdbuf());
+        Output::capture = &captured;
+
+        Error run_err = Error::OK;
+        try
+        {
+            run_err = RunFile(script_path);
+        }
+        catch (...)
+        {
+            Output::capture = nullptr;
+            std::cout.rdbuf(previous);
+            throw;
+        }
+
+        Output::capture = nullptr;
+        std::cout.rdbuf(previous);
+        out = captured.str();
+        return run_err;
+    }
+
+    // Runs the script interpreted, then with the JIT, and reports the first line where the outputs differ.
+    Error RunFileJitDiff(const std::string &script_path)
+    {
+        std::string interpreted;
+        std::string compiled;
+
+        Jit::enabled = false;
+        Error interpreted_err = RunFileCaptured(script_path, interpreted);
+
+        Jit::enabled = Jit::IsSupported();
+        Error compiled_err = RunFileCaptured(script_path, compiled);
+
+        if (interpreted != compiled)
+        {
+            std::istringstream lhs(interpreted);
+            std::istringstream rhs(compiled);
+            std::string lhs_line;
+            std::string rhs_line;
+            size_t line = 1;
+
+            while (true)
+            {
+                bool lhs_ok = static_cast<bool>(std::getline(lhs, lhs_line));
+                bool rhs_ok = static_cast<bool>(std::getline(rhs, rhs_line));
+                if (!lhs_ok)
+                    lhs_line = "<end of output>";
+                if (!rhs_ok)
+                    rhs_line = "<end of output>";
+                if (lhs_line != rhs_line || (!lhs_ok && !rhs_ok))
+                    break;
+                ++line;
+            }
+
+            Logger::Error("JIT output differs from interpreter output at line", {std::to_string(line)});
+            Logger::Print("  interpreter:", {lhs_line});
+            Logger::Print("  jit:        ", {rhs_line});
+            return Error::ASSERTION;
+        }
+
+        if (interpreted_err != compiled_err)
+        {
+            Logger::Error("JIT run ended with error", {std::to_string(compiled_err), "but the interpreter ended with", std::to_string(interpreted_err)});
+            return Error::ASSERTION;
+        }
+
+        std::cout << interpreted;
+        Logger::Info("JIT output matches interpreter output.", {});
+        return interpreted_err;
+    }
 }
\ No newline at end of file
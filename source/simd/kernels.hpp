@@ -0,0 +1,474 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GVS_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define GVS_SIMD_X86 0
+#endif
+
+// Bulk kernels of the typed arrays.
+// On x86-64 the AVX2 versions are picked at runtime, the float kernels fall back to SSE2,
+// which every x86-64 cpu has, and everything else to a scalar loop.
+// Int arithmetic wraps like the scalar loop, float sums add in a different order than it.
+namespace Simd
+{
+#if GVS_SIMD_X86
+    const bool has_avx2 = __builtin_cpu_supports("avx2");
+#else
+    const bool has_avx2 = false;
+#endif
+
+    namespace Scalar
+    {
+        int64_t SumInt(const int64_t *a, size_t n)
+        {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += static_cast<uint64_t>(a[i]);
+            return static_cast<int64_t>(sum);
+        }
+
+        double SumFloat(const double *a, size_t n)
+        {
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                sum += a[i];
+            return sum;
+        }
+
+        // 'n' must be at least 1.
+        template <typename T>
+        T Min(const T *a, size_t n)
+        {
+            T m = a[0];
+            for (size_t i = 1; i < n; ++i)
+                m = a[i] < m ? a[i] : m;
+            return m;
+        }
+
+        template <typename T>
+        T Max(const T *a, size_t n)
+        {
+            T m = a[0];
+            for (size_t i = 1; i < n; ++i)
+                m = a[i] > m ? a[i] : m;
+            return m;
+        }
+
+        int64_t DotInt(const int64_t *a, const int64_t *b, size_t n)
+        {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i)
+                sum += static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i]);
+            return static_cast<int64_t>(sum);
+        }
+
+        double DotFloat(const double *a, const double *b, size_t n)
+        {
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                sum += a[i] * b[i];
+            return sum;
+        }
+
+        void ScaleInt(int64_t *a, size_t n, int64_t k)
+        {
+            for (size_t i = 0; i < n; ++i)
+                a[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(k));
+        }
+
+        void ScaleFloat(double *a, size_t n, double k)
+        {
+            for (size_t i = 0; i < n; ++i)
+                a[i] *= k;
+        }
+
+        void AddInt(const int64_t *a, const int64_t *b, int64_t *out, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) + static_cast<uint64_t>(b[i]));
+        }
+
+        void AddFloat(const double *a, const double *b, double *out, size_t n)
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = a[i] + b[i];
+        }
+
+        template <typename T>
+        int64_t IndexOf(const T *a, size_t n, T value, size_t from = 0)
+        {
+            for (size_t i = from; i < n; ++i)
+            {
+                if (a[i] == value)
+                    return static_cast<int64_t>(i);
+            }
+            return -1;
+        }
+    }
+
+#if GVS_SIMD_X86
+    namespace Sse2
+    {
+        double SumFloat(const double *a, size_t n)
+        {
+            __m128d acc = _mm_setzero_pd();
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+                acc = _mm_add_pd(acc, _mm_loadu_pd(a + i));
+
+            double lanes[2];
+            _mm_storeu_pd(lanes, acc);
+            return lanes[0] + lanes[1] + Scalar::SumFloat(a + i, n - i);
+        }
+
+        double DotFloat(const double *a, const double *b, size_t n)
+        {
+            __m128d acc = _mm_setzero_pd();
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+
+            double lanes[2];
+            _mm_storeu_pd(lanes, acc);
+            return lanes[0] + lanes[1] + Scalar::DotFloat(a + i, b + i, n - i);
+        }
+
+        void ScaleFloat(double *a, size_t n, double k)
+        {
+            __m128d factor = _mm_set1_pd(k);
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(a + i, _mm_mul_pd(_mm_loadu_pd(a + i), factor));
+            Scalar::ScaleFloat(a + i, n - i, k);
+        }
+
+        void AddFloat(const double *a, const double *b, double *out, size_t n)
+        {
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+                _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            Scalar::AddFloat(a + i, b + i, out + i, n - i);
+        }
+    }
+
+    namespace Avx2
+    {
+        __attribute__((target("avx2"))) int64_t SumInt(const int64_t *a, size_t n)
+        {
+            __m256i acc = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)));
+
+            int64_t lanes[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            return static_cast<int64_t>(static_cast<uint64_t>(Scalar::SumInt(lanes, 4)) + static_cast<uint64_t>(Scalar::SumInt(a + i, n - i)));
+        }
+
+        __attribute__((target("avx2"))) double SumFloat(const double *a, size_t n)
+        {
+            __m256d acc = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                acc = _mm256_add_pd(acc, _mm256_loadu_pd(a + i));
+
+            double lanes[4];
+            _mm256_storeu_pd(lanes, acc);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + Scalar::SumFloat(a + i, n - i);
+        }
+
+        // AVX2 has no 64 bit int min/max, a compare and blend stands in.
+        __attribute__((target("avx2"))) int64_t MinInt(const int64_t *a, size_t n)
+        {
+            if (n < 4)
+                return Scalar::Min(a, n);
+
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+            size_t i = 4;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                acc = _mm256_blendv_epi8(acc, x, _mm256_cmpgt_epi64(acc, x));
+            }
+
+            int64_t lanes[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            int64_t m = Scalar::Min(lanes, 4);
+            if (i < n)
+            {
+                int64_t tail = Scalar::Min(a + i, n - i);
+                m = tail < m ? tail : m;
+            }
+            return m;
+        }
+
+        __attribute__((target("avx2"))) int64_t MaxInt(const int64_t *a, size_t n)
+        {
+            if (n < 4)
+                return Scalar::Max(a, n);
+
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+            size_t i = 4;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                acc = _mm256_blendv_epi8(acc, x, _mm256_cmpgt_epi64(x, acc));
+            }
+
+            int64_t lanes[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            int64_t m = Scalar::Max(lanes, 4);
+            if (i < n)
+            {
+                int64_t tail = Scalar::Max(a + i, n - i);
+                m = tail > m ? tail : m;
+            }
+            return m;
+        }
+
+        // min_pd(x, acc) is 'x < acc ? x : acc', the same as the scalar loop.
+        __attribute__((target("avx2"))) double MinFloat(const double *a, size_t n)
+        {
+            if (n < 4)
+                return Scalar::Min(a, n);
+
+            __m256d acc = _mm256_loadu_pd(a);
+            size_t i = 4;
+            for (; i + 4 <= n; i += 4)
+                acc = _mm256_min_pd(_mm256_loadu_pd(a + i), acc);
+
+            double lanes[4];
+            _mm256_storeu_pd(lanes, acc);
+            double m = Scalar::Min(lanes, 4);
+            if (i < n)
+            {
+                double tail = Scalar::Min(a + i, n - i);
+                m = tail < m ? tail : m;
+            }
+            return m;
+        }
+
+        __attribute__((target("avx2"))) double MaxFloat(const double *a, size_t n)
+        {
+            if (n < 4)
+                return Scalar::Max(a, n);
+
+            __m256d acc = _mm256_loadu_pd(a);
+            size_t i = 4;
+            for (; i + 4 <= n; i += 4)
+                acc = _mm256_max_pd(_mm256_loadu_pd(a + i), acc);
+
+            double lanes[4];
+            _mm256_storeu_pd(lanes, acc);
+            double m = Scalar::Max(lanes, 4);
+            if (i < n)
+            {
+                double tail = Scalar::Max(a + i, n - i);
+                m = tail > m ? tail : m;
+            }
+            return m;
+        }
+
+        __attribute__((target("avx2"))) double DotFloat(const double *a, const double *b, size_t n)
+        {
+            __m256d acc = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+
+            double lanes[4];
+            _mm256_storeu_pd(lanes, acc);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + Scalar::DotFloat(a + i, b + i, n - i);
+        }
+
+        __attribute__((target("avx2"))) void ScaleFloat(double *a, size_t n, double k)
+        {
+            __m256d factor = _mm256_set1_pd(k);
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+            Scalar::ScaleFloat(a + i, n - i, k);
+        }
+
+        __attribute__((target("avx2"))) void AddInt(const int64_t *a, const int64_t *b, int64_t *out, size_t n)
+        {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_add_epi64(x, y));
+            }
+            Scalar::AddInt(a + i, b + i, out + i, n - i);
+        }
+
+        __attribute__((target("avx2"))) void AddFloat(const double *a, const double *b, double *out, size_t n)
+        {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+                _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+            Scalar::AddFloat(a + i, b + i, out + i, n - i);
+        }
+
+        __attribute__((target("avx2"))) int64_t IndexOfInt(const int64_t *a, size_t n, int64_t value)
+        {
+            __m256i needle = _mm256_set1_epi64x(value);
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(x, needle)));
+                if (mask)
+                    return static_cast<int64_t>(i) + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+            return Scalar::IndexOf(a, n, value, i);
+        }
+
+        __attribute__((target("avx2"))) int64_t IndexOfFloat(const double *a, size_t n, double value)
+        {
+            __m256d needle = _mm256_set1_pd(value);
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), needle, _CMP_EQ_OQ));
+                if (mask)
+                    return static_cast<int64_t>(i) + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+            return Scalar::IndexOf(a, n, value, i);
+        }
+    }
+#endif
+
+    int64_t SumInt(const int64_t *a, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::SumInt(a, n);
+#endif
+        return Scalar::SumInt(a, n);
+    }
+
+    double SumFloat(const double *a, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::SumFloat(a, n);
+        return Sse2::SumFloat(a, n);
+#else
+        return Scalar::SumFloat(a, n);
+#endif
+    }
+
+    // 'n' must be at least 1.
+    int64_t MinInt(const int64_t *a, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::MinInt(a, n);
+#endif
+        return Scalar::Min(a, n);
+    }
+
+    int64_t MaxInt(const int64_t *a, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::MaxInt(a, n);
+#endif
+        return Scalar::Max(a, n);
+    }
+
+    double MinFloat(const double *a, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::MinFloat(a, n);
+#endif
+        return Scalar::Min(a, n);
+    }
+
+    double MaxFloat(const double *a, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::MaxFloat(a, n);
+#endif
+        return Scalar::Max(a, n);
+    }
+
+    // AVX2 has no 64 bit int multiply, the int products stay scalar.
+    int64_t DotInt(const int64_t *a, const int64_t *b, size_t n)
+    {
+        return Scalar::DotInt(a, b, n);
+    }
+
+    double DotFloat(const double *a, const double *b, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::DotFloat(a, b, n);
+        return Sse2::DotFloat(a, b, n);
+#else
+        return Scalar::DotFloat(a, b, n);
+#endif
+    }
+
+    void ScaleInt(int64_t *a, size_t n, int64_t k)
+    {
+        Scalar::ScaleInt(a, n, k);
+    }
+
+    void ScaleFloat(double *a, size_t n, double k)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::ScaleFloat(a, n, k);
+        return Sse2::ScaleFloat(a, n, k);
+#else
+        Scalar::ScaleFloat(a, n, k);
+#endif
+    }
+
+    void AddInt(const int64_t *a, const int64_t *b, int64_t *out, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::AddInt(a, b, out, n);
+#endif
+        Scalar::AddInt(a, b, out, n);
+    }
+
+    void AddFloat(const double *a, const double *b, double *out, size_t n)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::AddFloat(a, b, out, n);
+        return Sse2::AddFloat(a, b, out, n);
+#else
+        Scalar::AddFloat(a, b, out, n);
+#endif
+    }
+
+    int64_t IndexOfInt(const int64_t *a, size_t n, int64_t value)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::IndexOfInt(a, n, value);
+#endif
+        return Scalar::IndexOf(a, n, value);
+    }
+
+    int64_t IndexOfFloat(const double *a, size_t n, double value)
+    {
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::IndexOfFloat(a, n, value);
+#endif
+        return Scalar::IndexOf(a, n, value);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#include "kernels.hpp"
+
+// Substring search of the string builtins.
+// Single bytes go to memchr. Longer needles compare the first and the last byte of the needle
+// against a block of positions at once and only run memcmp where both match, which skips most
+// of a haystack in a few instructions per block.
+namespace Simd
+{
+    namespace Scalar
+    {
+        size_t Find(std::string_view haystack, std::string_view needle, size_t from)
+        {
+            return haystack.find(needle, from);
+        }
+    }
+
+#if GVS_SIMD_X86
+    namespace Sse2
+    {
+        size_t Find(std::string_view haystack, std::string_view needle, size_t from)
+        {
+            const char *h = haystack.data();
+            size_t m = needle.size();
+            size_t last = haystack.size() - m;
+            __m128i first_byte = _mm_set1_epi8(needle[0]);
+            __m128i last_byte = _mm_set1_epi8(needle[m - 1]);
+
+            size_t i = from;
+            for (; i + 16 <= last + 1; i += 16)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i + m - 1));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first_byte), _mm_cmpeq_epi8(b, last_byte))));
+                for (; mask; mask &= mask - 1)
+                {
+                    size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+                    if (!std::memcmp(h + pos + 1, needle.data() + 1, m - 2))
+                        return pos;
+                }
+            }
+            return Scalar::Find(haystack, needle, i);
+        }
+    }
+
+    namespace Avx2
+    {
+        __attribute__((target("avx2"))) size_t Find(std::string_view haystack, std::string_view needle, size_t from)
+        {
+            const char *h = haystack.data();
+            size_t m = needle.size();
+            size_t last = haystack.size() - m;
+            __m256i first_byte = _mm256_set1_epi8(needle[0]);
+            __m256i last_byte = _mm256_set1_epi8(needle[m - 1]);
+
+            size_t i = from;
+            for (; i + 32 <= last + 1; i += 32)
+            {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(h + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(h + i + m - 1));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first_byte), _mm256_cmpeq_epi8(b, last_byte))));
+                for (; mask; mask &= mask - 1)
+                {
+                    size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+                    if (!std::memcmp(h + pos + 1, needle.data() + 1, m - 2))
+                        return pos;
+                }
+            }
+            return Scalar::Find(haystack, needle, i);
+        }
+    }
+#endif
+
+    // Position of the first 'needle' at or after 'from', npos when there is none.
+    size_t Find(std::string_view haystack, std::string_view needle, size_t from = 0)
+    {
+        if (from > haystack.size() || needle.size() > haystack.size() - from)
+            return std::string_view::npos;
+        if (needle.empty())
+            return from;
+        if (needle.size() == 1)
+        {
+            const void *hit = std::memchr(haystack.data() + from, needle[0], haystack.size() - from);
+            return hit ? static_cast<size_t>(static_cast<const char *>(hit) - haystack.data()) : std::string_view::npos;
+        }
+#if GVS_SIMD_X86
+        if (has_avx2)
+            return Avx2::Find(haystack, needle, from);
+        return Sse2::Find(haystack, needle, from);
+#else
+        return Scalar::Find(haystack, needle, from);
+#endif
+    }
+}
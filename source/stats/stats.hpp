@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../types/token.hpp"
+#include "../types/scope.hpp"
+#include "../memory/memory.hpp"
+#include "../builtin/builtin_funcs.hpp"
+
+// Execution statistics collected with --stats, reported on stderr so script output stays untouched.
+namespace Stats
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keywords are numbered 200-299, instruction counts are indexed from KEYW_SET.
+    const size_t INSTRUCTION_SLOTS = 100;
+
+    struct FunctionStats
+    {
+        uint64_t calls = 0;
+        // Time of outermost activations only, so recursion is not counted twice.
+        uint64_t total_ns = 0;
+        uint64_t self_ns = 0;
+        // Memory::strings/Memory::arrays entries allocated and not attributed to callees.
+        uint64_t self_strings = 0;
+        uint64_t self_arrays = 0;
+        size_t active = 0;
+    };
+
+    struct ActiveCall
+    {
+        FunctionStats *stats;
+        Clock::time_point start;
+        size_t strings;
+        size_t arrays;
+        uint64_t child_ns;
+        size_t child_strings;
+        size_t child_arrays;
+    };
+
+    bool enabled = false;
+    bool json = false;
+
+    std::unordered_map<const Scope *, FunctionStats> functions = {};
+    std::unordered_map<BuiltinFuncs::BuiltinFunc, uint64_t> builtin_calls = {};
+    uint64_t instruction_counts[INSTRUCTION_SLOTS] = {};
+    std::vector<ActiveCall> call_stack = {};
+
+    void CountInstruction(Token::TYPE type)
+    {
+        size_t slot = static_cast<size_t>(type) - Token::KEYW_SET;
+        if (slot < INSTRUCTION_SLOTS)
+            ++instruction_counts[slot];
+    }
+
+    void CountBuiltin(BuiltinFuncs::BuiltinFunc func)
+    {
+        ++builtin_calls[func];
+    }
+
+    void EnterFunction(const Scope &scope)
+    {
+        FunctionStats &stats = functions[&scope];
+        ++stats.calls;
+        ++stats.active;
+        call_stack.push_back(ActiveCall{
+            .stats = &stats,
+            .start = Clock::now(),
+            .strings = Memory::string_stats.allocations,
+            .arrays = Memory::array_stats.allocations,
+            .child_ns = 0,
+            .child_strings = 0,
+            .child_arrays = 0,
+        });
+    }
+
+    void LeaveFunction()
+    {
+        if (!call_stack.size())
+            return;
+
+        ActiveCall call = call_stack.back();
+        call_stack.pop_back();
+
+        uint64_t elapsed = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - call.start).count());
+        size_t strings = Memory::string_stats.allocations - call.strings;
+        size_t arrays = Memory::array_stats.allocations - call.arrays;
+
+        FunctionStats &stats = *call.stats;
+        --stats.active;
+        if (!stats.active)
+            stats.total_ns += elapsed;
+        stats.self_ns += elapsed - std::min(elapsed, call.child_ns);
+        stats.self_strings += strings - std::min(strings, call.child_strings);
+        stats.self_arrays += arrays - std::min(arrays, call.child_arrays);
+
+        if (call_stack.size())
+        {
+            ActiveCall &caller = call_stack.back();
+            caller.child_ns += elapsed;
+            caller.child_strings += strings;
+            caller.child_arrays += arrays;
+        }
+    }
+
+    namespace
+    {
+        std::string BuiltinName(BuiltinFuncs::BuiltinFunc func)
+        {
+            for (const auto &[name, builtin] : BuiltinFuncs::BUILTIN_MAP)
+            {
+                if (builtin == func)
+                    return name;
+            }
+            return "?";
+        }
+
+        // Quoted JSON string, control characters are written as \u00XX escapes.
+        std::string JsonString(const std::string &s)
+        {
+            static const char HEX[] = "0123456789abcdef";
+            std::string out = "\"";
+            for (char c : s)
+            {
+                unsigned char byte = static_cast<unsigned char>(c);
+                if (byte < 0x20)
+                {
+                    out += "\\u00";
+                    out += HEX[byte >> 4];
+                    out += HEX[byte & 0xF];
+                    continue;
+                }
+                if (c == '"' || c == '\\')
+                    out += '\\';
+                out += c;
+            }
+            return out + "\"";
+        }
+
+        double Millis(uint64_t ns)
+        {
+            return static_cast<double>(ns) / 1e6;
+        }
+
+        template <typename T>
+        std::vector<std::pair<std::string, T>> SortedDescending(std::vector<std::pair<std::string, T>> rows,
+                                                                 uint64_t (*key)(const T &))
+        {
+            std::stable_sort(rows.begin(), rows.end(), [key](const auto &a, const auto &b)
+                             { return key(a.second) > key(b.second); });
+            return rows;
+        }
+    }
+
+    void Report(std::ostream &out)
+    {
+        std::vector<std::pair<std::string, FunctionStats>> funcs{};
+        for (const auto &[scope, stats] : functions)
+            funcs.push_back({QualifiedScopeName(*scope), stats});
+        funcs = SortedDescending<FunctionStats>(funcs, [](const FunctionStats &s)
+                                                { return s.self_ns; });
+
+        std::vector<std::pair<std::string, uint64_t>> insts{};
+        for (size_t i = 0; i < INSTRUCTION_SLOTS; ++i)
+        {
+            if (!instruction_counts[i])
+                continue;
+            Token::TYPE type = static_cast<Token::TYPE>(Token::KEYW_SET + i);
+            auto it = Token::TYPE_TO_STR.find(type);
+            insts.push_back({it != Token::TYPE_TO_STR.end() ? it->second : std::to_string(type), instruction_counts[i]});
+        }
+        insts = SortedDescending<uint64_t>(insts, [](const uint64_t &n)
+                                           { return n; });
+
+        std::vector<std::pair<std::string, uint64_t>> builtins{};
+        for (const auto &[func, count] : builtin_calls)
+            builtins.push_back({BuiltinName(func), count});
+        builtins = SortedDescending<uint64_t>(builtins, [](const uint64_t &n)
+                                              { return n; });
+
+        if (json)
+        {
+            out << "{\"functions\":[";
+            for (size_t i = 0; i < funcs.size(); ++i)
+            {
+                const FunctionStats &s = funcs[i].second;
+                out << (i ? "," : "") << "{\"name\":" << JsonString(funcs[i].first)
+                    << ",\"calls\":" << s.calls
+                    << ",\"total_ns\":" << s.total_ns
+                    << ",\"self_ns\":" << s.self_ns
+                    << ",\"strings\":" << s.self_strings
+                    << ",\"arrays\":" << s.self_arrays << "}";
+            }
+            out << "],\"instructions\":{";
+            for (size_t i = 0; i < insts.size(); ++i)
+                out << (i ? "," : "") << JsonString(insts[i].first) << ":" << insts[i].second;
+            out << "},\"builtins\":{";
+            for (size_t i = 0; i < builtins.size(); ++i)
+                out << (i ? "," : "") << JsonString(builtins[i].first) << ":" << builtins[i].second;
+            out << "}}\n";
+            return;
+        }
+
+        out << "\nFunctions (sorted by self time):\n";
+        out << std::left << std::setw(32) << "  name" << std::right
+            << std::setw(10) << "calls" << std::setw(14) << "total ms" << std::setw(14) << "self ms"
+            << std::setw(10) << "strings" << std::setw(10) << "arrays" << "\n";
+        for (const auto &[name, s] : funcs)
+        {
+            out << "  " << std::left << std::setw(30) << name << std::right
+                << std::setw(10) << s.calls
+                << std::setw(14) << std::fixed << std::setprecision(3) << Millis(s.total_ns)
+                << std::setw(14) << Millis(s.self_ns)
+                << std::setw(10) << s.self_strings
+                << std::setw(10) << s.self_arrays << "\n";
+        }
+
+        out << "\nInstructions:\n";
+        for (const auto &[name, count] : insts)
+            out << "  " << std::left << std::setw(30) << name << std::right << std::setw(10) << count << "\n";
+
+        out << "\nBuiltins:\n";
+        for (const auto &[name, count] : builtins)
+            out << "  " << std::left << std::setw(30) << name << std::right << std::setw(10) << count << "\n";
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "../types/token.hpp"
+#include "../types/scope.hpp"
+
+// Entries kept by the execution trace, must be a power of two.
+#ifndef GVS_TRACE_SIZE
+#define GVS_TRACE_SIZE 256
+#endif
+
+// Always-on ring buffer of the last executed instructions, dumped on Panic,
+// on exceptions escaping the interpreter and by the TraceDump builtin.
+namespace Trace
+{
+    const size_t CAPACITY = GVS_TRACE_SIZE;
+    static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "GVS_TRACE_SIZE must be a power of two");
+
+    struct Entry
+    {
+        const Scope *scope;
+        uint64_t ticks;
+        uint32_t index;
+        Token::TYPE type;
+    };
+
+    Entry ring[CAPACITY] = {};
+    // Instructions recorded so far, the next entry written is ring[head % CAPACITY].
+    uint64_t head = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char *const TICK_UNIT = "cycles";
+
+    inline uint64_t Now()
+    {
+        return __builtin_ia32_rdtsc();
+    }
+#else
+    const char *const TICK_UNIT = "ns";
+
+    inline uint64_t Now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+#endif
+
+    inline void Record(const Scope *scope, size_t index, Token::TYPE type)
+    {
+        ring[head & (CAPACITY - 1)] = Entry{
+            .scope = scope,
+            .ticks = Now(),
+            .index = static_cast<uint32_t>(index),
+            .type = type,
+        };
+        ++head;
+    }
+
+    void Reset()
+    {
+        head = 0;
+    }
+
+    // Prints up to 'count' of the newest entries, oldest first, returns how many were printed.
+    // Must run while the traced scopes are alive.
+    size_t Dump(std::ostream &out, size_t count = CAPACITY)
+    {
+        size_t available = head < CAPACITY ? static_cast<size_t>(head) : CAPACITY;
+        if (count > available)
+            count = available;
+        if (!count)
+            return 0;
+
+        uint64_t newest = ring[(head - 1) & (CAPACITY - 1)].ticks;
+        out << "Trace of the last " << count << " instructions, oldest first (" << TICK_UNIT << " before the newest):\n";
+        for (uint64_t i = head - count; i < head; ++i)
+        {
+            const Entry &entry = ring[i & (CAPACITY - 1)];
+            std::string line = "?";
+            if (entry.index < entry.scope->instructions.size() && entry.scope->instructions[entry.index].args.size())
+                line = std::to_string(entry.scope->instructions[entry.index].args[0].line);
+
+            auto name = Token::TYPE_TO_STR.find(entry.type);
+            out << "  -" << (newest > entry.ticks ? newest - entry.ticks : 0) << "\t" << QualifiedScopeName(*entry.scope)
+                << ":" << line << " #" << entry.index << " "
+                << (name != Token::TYPE_TO_STR.end() ? name->second : std::to_string(entry.type)) << "\n";
+        }
+        return count;
+    }
+}
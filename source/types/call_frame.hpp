@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+struct Scope;
+
+// Entry of the interpreter's call stack, one per scope being executed.
+struct CallFrame
+{
+    const Scope *scope;
+    // Index of the instruction being executed in scope->instructions.
+    size_t ip;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "token.hpp"
+#include "variant.hpp"
+
+enum class OPCODE : uint8_t
+{
+    PUSH_CONST,
+    PUSH_NAME,
+    NEG,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    LT,
+    GT,
+    LE,
+    GE,
+    EQ,
+    NE,
+};
+
+// Specialization a binary op rewrote itself into on first execution.
+enum class QUICK : uint8_t
+{
+    UNSEEN,
+    GENERIC,
+    INT_INT,
+    FLOAT_FLOAT,
+    STRING_STRING,
+};
+
+// One step of a compiled expression, evaluated on a small value stack.
+struct ExprOp
+{
+    OPCODE code;
+    QUICK quick = QUICK::UNSEEN;
+    // Operand of PUSH_CONST.
+    Variant value;
+    // Operand of PUSH_NAME, its cache points at the variable slot.
+    Token::Token name;
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "nan_box.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Open addressing hash table in the style of SwissTable, the storage of maps.
+// One control byte per slot holds 7 bits of the hash of a full slot, so a probe compares
+// a group of 16 slots with one SSE2 compare and mostly touches one line of slots.
+// Keys are the bits of a canonical Variant: equal keys have equal bits, see VarMapKey.
+struct HashMap
+{
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr size_t MIN_CAPACITY = 16;
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+
+    struct Slot
+    {
+        uint64_t key;
+        Variant value;
+    };
+
+    // 'capacity' control bytes, followed by a copy of the first GROUP_WIDTH so a group read never wraps.
+    std::vector<int8_t> ctrl = {};
+    std::vector<Slot> slots = {};
+    size_t count = 0;
+    // Insertions into empty slots left before the table is rebuilt, keeps the load under 7/8.
+    size_t growth_left = 0;
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t capacity() const
+    {
+        return slots.size();
+    }
+
+    static uint64_t Hash(uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDULL;
+        key ^= key >> 33;
+        key *= 0xC4CEB9FE1A85EC53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    // Slot holding 'key', null when it is absent.
+    const Slot *Find(uint64_t key) const
+    {
+        if (!count)
+            return nullptr;
+
+        uint64_t hash = Hash(key);
+        int8_t h2 = static_cast<int8_t>(hash & 0x7F);
+        size_t mask = capacity() - 1;
+        size_t pos = (hash >> 7) & mask;
+        for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH)
+        {
+            const int8_t *group = ctrl.data() + pos;
+            for (uint32_t bits = Match(group, h2); bits; bits &= bits - 1)
+            {
+                const Slot &slot = slots[(pos + std::countr_zero(bits)) & mask];
+                if (slot.key == key)
+                    return &slot;
+            }
+            if (Match(group, EMPTY))
+                return nullptr;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    Slot *Find(uint64_t key)
+    {
+        return const_cast<Slot *>(static_cast<const HashMap *>(this)->Find(key));
+    }
+
+    // Inserts or overwrites 'key'.
+    void Set(uint64_t key, Variant value)
+    {
+        if (Slot *slot = Find(key))
+        {
+            slot->value = value;
+            return;
+        }
+
+        if (!growth_left)
+            Rehash(count + 1 > capacity() * 7 / 16 ? capacity() * 2 : capacity());
+
+        uint64_t hash = Hash(key);
+        size_t index = FindInsertSlot(hash);
+        if (ctrl[index] == EMPTY)
+            --growth_left;
+        SetCtrl(index, static_cast<int8_t>(hash & 0x7F));
+        slots[index] = Slot{.key = key, .value = value};
+        ++count;
+    }
+
+    // Returns false when 'key' was absent. The slot turns into a tombstone, reclaimed by the next rebuild.
+    bool Erase(uint64_t key)
+    {
+        Slot *slot = Find(key);
+        if (!slot)
+            return false;
+
+        SetCtrl(static_cast<size_t>(slot - slots.data()), DELETED);
+        --count;
+        return true;
+    }
+
+    // Calls 'f' with every full slot, in slot order.
+    template <typename F>
+    void ForEach(F f) const
+    {
+        for (size_t i = 0; i < capacity(); ++i)
+        {
+            if (ctrl[i] >= 0)
+                f(slots[i]);
+        }
+    }
+
+private:
+    // Bit i is set when byte i of the group equals 'value'.
+    static uint32_t Match(const int8_t *group, int8_t value)
+    {
+#if defined(__SSE2__)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+        uint32_t bits = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; ++i)
+            bits |= static_cast<uint32_t>(group[i] == value) << i;
+        return bits;
+#endif
+    }
+
+    // First empty or deleted slot on the probe sequence of 'hash'.
+    size_t FindInsertSlot(uint64_t hash) const
+    {
+        size_t mask = capacity() - 1;
+        size_t pos = (hash >> 7) & mask;
+        for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH)
+        {
+            const int8_t *group = ctrl.data() + pos;
+            uint32_t bits = Match(group, EMPTY) | Match(group, DELETED);
+            if (bits)
+                return (pos + std::countr_zero(bits)) & mask;
+            pos = (pos + step) & mask;
+        }
+    }
+
+    void SetCtrl(size_t index, int8_t value)
+    {
+        ctrl[index] = value;
+        if (index < GROUP_WIDTH)
+            ctrl[capacity() + index] = value;
+    }
+
+    // Rebuilds the table with 'new_capacity' slots, dropping the tombstones.
+    void Rehash(size_t new_capacity)
+    {
+        if (new_capacity < MIN_CAPACITY)
+            new_capacity = MIN_CAPACITY;
+
+        std::vector<int8_t> old_ctrl = std::move(ctrl);
+        std::vector<Slot> old_slots = std::move(slots);
+
+        ctrl.assign(new_capacity + GROUP_WIDTH, EMPTY);
+        slots.assign(new_capacity, Slot{.key = 0, .value = {0}});
+        growth_left = new_capacity * 7 / 8 - count;
+
+        for (size_t i = 0; i < old_slots.size(); ++i)
+        {
+            if (old_ctrl[i] < 0)
+                continue;
+            uint64_t hash = Hash(old_slots[i].key);
+            size_t index = FindInsertSlot(hash);
+            SetCtrl(index, static_cast<int8_t>(hash & 0x7F));
+            slots[index] = old_slots[i];
+        }
+    }
+};
@@ -3,9 +3,23 @@
 #include <iostream>
 
 #include "token.hpp"
+#include "expression.hpp"
 
 struct Instruction
 {
     Token::TYPE type;
     std::vector<Token::Token> args;
+    // Control flow targets resolved by Compiler::ResolveJumps.
+    size_t jump = 0;
+    size_t exit = 0;
+    // Loop counter register used by 'for'/'endfor'.
+    size_t reg = 0;
+    // Compiled value of set/var/const/return or condition of if/elif/while, empty if none.
+    std::vector<ExprOp> expr = {};
+    // Argument values of call/fetch or of a condition calling a function, see Compiler::CompileCallArguments.
+    std::vector<Variant> call_args = {};
+    // Set on set/var/fetch of a local which does not escape the function, see Compiler::MarkLocalTargets.
+    bool local_target = false;
+    // Set on 'fetch a, F, a, ...', where the result replaces the first argument, see Registers::first_arg_owned.
+    bool owns_first_arg = false;
 };
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// JIT bookkeeping of a function scope.
+struct JitInfo
+{
+    // Calls made while the scope was still interpreted.
+    size_t calls = 0;
+    // Entry point of the compiled code, null until compiled.
+    void *entry = nullptr;
+    // Set when compiling failed or the compiled code went stale, the scope stays interpreted.
+    bool disabled = false;
+    // Scope tree version the builtin call sites were last checked against.
+    uint64_t version = 0;
+    // Instructions compiled as direct builtin calls.
+    std::vector<size_t> builtin_sites = {};
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "variant.hpp"
+
+// Integer register backing a 'for' loop.
+struct LoopCounter
+{
+    VarInt value = 0;
+    VarInt end = 0;
+    VarInt step = 1;
+};
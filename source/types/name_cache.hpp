@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+struct Scope;
+struct Variant;
+
+// Per call-site memo of a name lookup, valid while 'version' matches
+// Global::scope_tree_version and the lookup happens from 'context'.
+struct NameCache
+{
+    uint64_t version = 0;
+    Scope *context = nullptr;
+    Scope *scope = nullptr;
+    Variant *slot = nullptr;
+    // Set when the name resolved to a builtin.
+    Variant (*builtin)(const Variant *args, size_t args_count, bool &errored) = nullptr;
+    // Set when the name is a struct field, 'slot' then holds the instance and the
+    // field is read from slot 'field' while the instance still has 'shape'.
+    uint32_t shape = 0;
+    uint32_t field = UINT32_MAX;
+};
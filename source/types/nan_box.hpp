@@ -0,0 +1,130 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+// Every value of the interpreter is 8 bytes: variables, arguments, registers and elements.
+// Doubles are stored as they are, with every NaN canonicalized to the positive quiet NaN.
+// Other values live in the negative quiet NaN space: a 3 bit tag in bits 48-50 and a 48 bit payload.
+// Ints outside the 48 bit range are boxed, the payload is their slot in Memory::boxed_ints.
+// Strings up to 5 bytes keep their characters in the low 40 bits and their length in bits 40-47.
+// Read and built through get_variant.hpp and make_variant.hpp, code outside them does not see the bits.
+namespace Packed
+{
+    const uint64_t BOX_PREFIX = 0xFFF8000000000000ULL;
+    const uint64_t TAG_SHIFT = 48;
+    const uint64_t TAG_MASK = 0x7ULL << TAG_SHIFT;
+    const uint64_t PAYLOAD_MASK = (1ULL << TAG_SHIFT) - 1;
+    const uint64_t CANONICAL_NAN = 0x7FF8000000000000ULL;
+    const uint64_t EXPONENT_MASK = 0x7FF0000000000000ULL;
+    const uint64_t MANTISSA_MASK = (1ULL << 52) - 1;
+
+    const int64_t INT48_MIN = -(1LL << 47);
+    const int64_t INT48_MAX = (1LL << 47) - 1;
+
+    enum class TAG : uint8_t
+    {
+        // Handle of a typed array, struct instance or a string which is not a slot of its own, see OBJECT_KIND.
+        OBJECT = 0,
+        INT = 1,
+        NIL = 2,
+        STRING = 3,
+        ARRAY = 4,
+        BOXED_INT = 5,
+        MAP = 6,
+        SHORT_STRING = 7,
+    };
+
+    const uint64_t NIL_BITS = BOX_PREFIX | (static_cast<uint64_t>(TAG::NIL) << TAG_SHIFT);
+}
+
+// Null unless initialized otherwise.
+struct Variant
+{
+    uint64_t bits = Packed::NIL_BITS;
+};
+
+static_assert(sizeof(Variant) == 8);
+
+namespace Packed
+{
+    // Payload of an OBJECT: its kind in bits 44-47 and its slot in the low 44 bits.
+    enum class OBJECT_KIND : uint8_t
+    {
+        TYPED_ARRAY = 0,
+        STRUCT = 1,
+        STRING_SLICE = 2,
+        // Characters in the frame arena, the payload is their length and offset, see Memory::AllocTemp.
+        TEMP_STRING = 3,
+    };
+
+    const uint64_t OBJECT_KIND_SHIFT = 44;
+    const uint64_t OBJECT_SLOT_MASK = (1ULL << OBJECT_KIND_SHIFT) - 1;
+
+    const size_t SHORT_STRING_CAPACITY = 5;
+    const uint64_t SHORT_STRING_LEN_SHIFT = 40;
+
+    constexpr bool IsDouble(Variant v)
+    {
+        return (v.bits & BOX_PREFIX) != BOX_PREFIX;
+    }
+
+    constexpr TAG TagOf(Variant v)
+    {
+        return static_cast<TAG>((v.bits & TAG_MASK) >> TAG_SHIFT);
+    }
+
+    constexpr uint64_t PayloadOf(Variant v)
+    {
+        return v.bits & PAYLOAD_MASK;
+    }
+
+    constexpr Variant Box(TAG tag, uint64_t payload)
+    {
+        return Variant{BOX_PREFIX | (static_cast<uint64_t>(tag) << TAG_SHIFT) | (payload & PAYLOAD_MASK)};
+    }
+
+    // Tested on the bits, -Ofast lets the compiler fold std::isnan to false.
+    constexpr bool IsNaN(double d)
+    {
+        uint64_t bits = std::bit_cast<uint64_t>(d);
+        return (bits & EXPONENT_MASK) == EXPONENT_MASK && (bits & MANTISSA_MASK) != 0;
+    }
+
+    // A NaN left as it is could read back as a box, x86-64 makes 0.0 / 0.0 the bits of an OBJECT in slot 0.
+    constexpr Variant FromDouble(double d)
+    {
+        return Variant{IsNaN(d) ? CANONICAL_NAN : std::bit_cast<uint64_t>(d)};
+    }
+
+    constexpr bool FitsInt48(int64_t i)
+    {
+        return i >= INT48_MIN && i <= INT48_MAX;
+    }
+
+    constexpr Variant FromInt48(int64_t i)
+    {
+        return Box(TAG::INT, static_cast<uint64_t>(i));
+    }
+
+    // Sign extends the 48 bit payload.
+    constexpr int64_t Int48Of(Variant v)
+    {
+        return static_cast<int64_t>(PayloadOf(v) << 16) >> 16;
+    }
+
+    constexpr Variant BoxObject(OBJECT_KIND kind, uint64_t slot)
+    {
+        return Box(TAG::OBJECT, (static_cast<uint64_t>(kind) << OBJECT_KIND_SHIFT) | (slot & OBJECT_SLOT_MASK));
+    }
+
+    constexpr OBJECT_KIND ObjectKindOf(Variant v)
+    {
+        return static_cast<OBJECT_KIND>(PayloadOf(v) >> OBJECT_KIND_SHIFT);
+    }
+
+    constexpr uint64_t ObjectSlotOf(Variant v)
+    {
+        return PayloadOf(v) & OBJECT_SLOT_MASK;
+    }
+}
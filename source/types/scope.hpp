@@ -3,9 +3,11 @@
 #include <cstdint>
 #include <iostream>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "variant.hpp"
 #include "instructions.hpp"
+#include "jit_info.hpp"
 
 enum class SCOPE_TYPE : uint8_t
 {
@@ -15,19 +17,33 @@ enum class SCOPE_TYPE : uint8_t
     NAMESPACE,
 };
 
-struct ScopeRuntimeVars
-{
-    size_t if_depth = 0;
-};
-
 struct Scope
 {
     SCOPE_TYPE type;
     Scope *parent;
-    ScopeRuntimeVars runtime_vars;
     std::string name;
     std::vector<std::pair<std::string, Variant>> args;
     std::unordered_map<std::string, Variant> vars;
+    // Names of 'vars' declared with 'const', values do not carry it.
+    std::unordered_set<std::string> consts;
     std::unordered_map<std::string, Scope> scopes;
     std::vector<Instruction> instructions;
-};
\ No newline at end of file
+    // Number of loop counter registers needed by nested 'for' blocks.
+    size_t loop_depth = 0;
+    // Index in Shapes::shapes of a struct, built at its first instantiation.
+    uint32_t shape = NO_SHAPE;
+    JitInfo jit = {};
+};
+
+// Dotted path of a scope from the global scope, like the names used in 'call'.
+// Imported files are named '#alias' internally, reports show the alias alone.
+std::string QualifiedScopeName(const Scope &scope)
+{
+    auto shown = [](const std::string &name)
+    { return name.starts_with("#") ? name.substr(1) : name; };
+
+    std::string name = shown(scope.name);
+    for (const Scope *parent = scope.parent; parent && parent->parent; parent = parent->parent)
+        name = shown(parent->name) + "." + name;
+    return name;
+}
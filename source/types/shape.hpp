@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nan_box.hpp"
+
+struct Scope;
+
+const uint32_t NO_SHAPE = UINT32_MAX;
+
+// Layout of the instances of a struct: field 'i' is 'fields[i]' and lives in slot 'i' of an instance.
+// Built once from the 'var'/'const' instructions of the struct body, in their order.
+struct Shape
+{
+    const Scope *scope = nullptr;
+    std::vector<std::string> fields = {};
+    std::unordered_map<std::string, uint32_t> index = {};
+    // Initial values of the fields, copied into every new instance.
+    std::vector<Variant> defaults = {};
+};
+
+// A struct instance, its fields are one buffer sized by the shape.
+struct StructInstance
+{
+    uint32_t shape = NO_SHAPE;
+    std::vector<Variant> fields = {};
+};
+
+namespace Shapes
+{
+    // Indexed by Scope::shape, never shrinks.
+    std::vector<Shape> shapes = {};
+
+    const uint32_t NO_FIELD = UINT32_MAX;
+
+    uint32_t FieldIndex(uint32_t shape, const std::string &field)
+    {
+        auto it = shapes[shape].index.find(field);
+        return it == shapes[shape].index.end() ? NO_FIELD : it->second;
+    }
+}
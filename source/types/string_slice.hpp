@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Characters [offset, offset + size) of a string in Memory::strings, made by Substr, Slice and Split
+// without copying them. The parent stays alive as long as a slice of it does.
+struct StringSlice
+{
+    uint64_t parent = 0;
+    size_t offset = 0;
+    size_t size = 0;
+};
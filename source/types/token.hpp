@@ -3,6 +3,8 @@
 #include <iostream>
 #include <map>
 
+#include "name_cache.hpp"
+
 namespace Token
 {
     enum TYPE
@@ -34,6 +36,26 @@ namespace Token
         KEYW_ELSE = 213,
         KEYW_ENDIF = 214,
         KEYW_FETCH = 215,
+        KEYW_WHILE = 216,
+        KEYW_ENDWHILE = 217,
+        KEYW_FOR = 218,
+        KEYW_ENDFOR = 219,
+        KEYW_BREAK = 220,
+        KEYW_CONTINUE = 221,
+        /* operators */
+        OP_ADD = 300,
+        OP_SUB = 301,
+        OP_MUL = 302,
+        OP_DIV = 303,
+        OP_MOD = 304,
+        OP_LT = 305,
+        OP_GT = 306,
+        OP_LE = 307,
+        OP_GE = 308,
+        OP_EQ = 309,
+        OP_NE = 310,
+        PAREN_OPEN = 311,
+        PAREN_CLOSE = 312,
     };
 
     const std::map<TYPE, std::string> TYPE_TO_STR{
@@ -51,7 +73,7 @@ namespace Token
         {KEYW_CALL, "keyword-call"},
         {KEYW_STRUCT, "keyword-struct"},
         {KEYW_FUNC, "keyword-func"},
-        {KEYW_FETCH, "keyword-func"},
+        {KEYW_FETCH, "keyword-fetch"},
         {KEYW_IMPORT, "keyword-import"},
         {KEYW_RETURN, "keyword-return"},
         {KEYW_END, "keyword-end"},
@@ -63,6 +85,26 @@ namespace Token
         {KEYW_ELIF, "keyword-elif"},
         {KEYW_ELSE, "keyword-else"},
         {KEYW_ENDIF, "keyword-endif"},
+        {KEYW_WHILE, "keyword-while"},
+        {KEYW_ENDWHILE, "keyword-endwhile"},
+        {KEYW_FOR, "keyword-for"},
+        {KEYW_ENDFOR, "keyword-endfor"},
+        {KEYW_BREAK, "keyword-break"},
+        {KEYW_CONTINUE, "keyword-continue"},
+
+        {OP_ADD, "operator-add"},
+        {OP_SUB, "operator-sub"},
+        {OP_MUL, "operator-mul"},
+        {OP_DIV, "operator-div"},
+        {OP_MOD, "operator-mod"},
+        {OP_LT, "operator-lt"},
+        {OP_GT, "operator-gt"},
+        {OP_LE, "operator-le"},
+        {OP_GE, "operator-ge"},
+        {OP_EQ, "operator-eq"},
+        {OP_NE, "operator-ne"},
+        {PAREN_OPEN, "paren-open"},
+        {PAREN_CLOSE, "paren-close"},
     };
 
     struct Token
@@ -71,5 +113,6 @@ namespace Token
         TYPE type = TYPE::NONE;
         uint16_t line = 1;
         uint16_t col = 1;
+        NameCache cache = {};
     };
 }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class ELEM_TYPE : uint8_t
+{
+    INT,
+    FLOAT,
+};
+
+// Homogeneous array stored as a contiguous buffer of its element type, only the buffer matching 'elem' is used.
+struct TypedArray
+{
+    ELEM_TYPE elem = ELEM_TYPE::INT;
+    std::vector<int64_t> ints;
+    std::vector<double> floats;
+
+    size_t size() const
+    {
+        return elem == ELEM_TYPE::INT ? ints.size() : floats.size();
+    }
+
+    size_t capacity() const
+    {
+        return elem == ELEM_TYPE::INT ? ints.capacity() : floats.capacity();
+    }
+};
@@ -2,9 +2,13 @@
 
 #include <cstdint>
 #include <iostream>
-#include <variant>
 
 #include "../types/error.hpp"
+#include "nan_box.hpp"
+#include "typed_array.hpp"
+#include "hash_map.hpp"
+#include "shape.hpp"
+#include "string_slice.hpp"
 
 enum class VALUE_TYPE : uint8_t
 {
@@ -13,31 +17,63 @@ enum class VALUE_TYPE : uint8_t
     FLOAT,
     STRING,
     ARRAY,
+    // Hash table of int/string keys, stored in Memory::maps.
     MAP,
+    // Homogeneous int or float array, stored in Memory::typed_arrays.
+    TYPED_ARRAY,
+    // Instance of a struct, stored in Memory::structs.
+    STRUCT,
 };
 
-struct VariantFlags
-{
-    uint8_t is_const : 1;
-};
+// Strings up to this many bytes are stored in the payload of their Variant instead of Memory::strings.
+const size_t INLINE_STRING_CAPACITY = Packed::SHORT_STRING_CAPACITY;
+
+const Variant NIL_VALUE = Packed::Box(Packed::TAG::NIL, 0);
 
-struct Variant
+// Type of a value, an int whether it fits the payload or is boxed, a string whatever holds its characters.
+inline VALUE_TYPE VarType(const Variant &v)
 {
-    VALUE_TYPE type;
-    VariantFlags flags;
+    if (Packed::IsDouble(v))
+        return VALUE_TYPE::FLOAT;
 
-    union
+    switch (Packed::TagOf(v))
     {
-        uint8_t d8;
-        uint16_t d16;
-        uint32_t d32;
-        uint64_t d64;
-    };
-};
+    case Packed::TAG::INT:
+    case Packed::TAG::BOXED_INT:
+        return VALUE_TYPE::INT;
+    case Packed::TAG::STRING:
+    case Packed::TAG::SHORT_STRING:
+        return VALUE_TYPE::STRING;
+    case Packed::TAG::ARRAY:
+        return VALUE_TYPE::ARRAY;
+    case Packed::TAG::MAP:
+        return VALUE_TYPE::MAP;
+    case Packed::TAG::OBJECT:
+        switch (Packed::ObjectKindOf(v))
+        {
+        case Packed::OBJECT_KIND::TYPED_ARRAY:
+            return VALUE_TYPE::TYPED_ARRAY;
+        case Packed::OBJECT_KIND::STRUCT:
+            return VALUE_TYPE::STRUCT;
+        default:
+            return VALUE_TYPE::STRING;
+        }
+    default:
+        return VALUE_TYPE::NIL;
+    }
+}
+
+// Slot of a stored string, slice, array, map, typed array or struct in its store.
+inline uint64_t VarGetHandle(const Variant &v)
+{
+    if (Packed::TagOf(v) == Packed::TAG::OBJECT)
+        return Packed::ObjectSlotOf(v);
+    return Packed::PayloadOf(v);
+}
 
 typedef double VarFloat;
 typedef int64_t VarInt;
 typedef int64_t VarNull;
 typedef std::string VarString;
 typedef std::vector<Variant> VarArray;
-typedef std::unordered_map<std::string, Variant> VarMap;
\ No newline at end of file
+typedef HashMap VarMap;
\ No newline at end of file